@@ -39,6 +39,17 @@ void spi_flash_init(void)
 }
 
 void spi_flash_sector_erase(uint32_t sector_addr)
+{
+    spi_flash_sector_erase_start(sector_addr);
+    spi_flash_wait_for_write_end();
+}
+
+/**
+ * @brief Issues a sector erase and returns while the erase is still running.
+ * @note  Poll spi_flash_is_busy() before the next access, or let the next blocking
+ *        call wait for it (write enable and reads wait for a pending operation).
+ */
+void spi_flash_sector_erase_start(uint32_t sector_addr)
 {
     spi_flash_write_enable();
 
@@ -48,8 +59,6 @@ void spi_flash_sector_erase(uint32_t sector_addr)
     spi_flash_send_byte((sector_addr & 0xFF00) >> 8);
     spi_flash_send_byte(sector_addr & 0xFF);
     SPI_FLASH_CS_HIGH();
-
-    spi_flash_wait_for_write_end();
 }
 
 void spi_flash_bulk_erase(void)
@@ -64,6 +73,16 @@ void spi_flash_bulk_erase(void)
 }
 
 void spi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
+{
+    spi_flash_page_write_start(pbuffer, write_addr, num_byte_to_write);
+    spi_flash_wait_for_write_end();
+}
+
+/**
+ * @brief Programs up to one page and returns while the program cycle is still running.
+ * @note  The data must not cross a page boundary.
+ */
+void spi_flash_page_write_start(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
 {
     spi_flash_write_enable();
 
@@ -80,7 +99,6 @@ void spi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_by
     }
 
     SPI_FLASH_CS_HIGH();
-    spi_flash_wait_for_write_end();
 }
 
 void spi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
@@ -153,6 +171,9 @@ void spi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_
 
 void spi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
 {
+    /* an erase/program started with a *_start() call may still be running */
+    spi_flash_wait_for_write_end();
+
     SPI_FLASH_CS_LOW();
     spi_flash_send_byte(READ);
     spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
@@ -213,11 +234,26 @@ uint16_t spi_flash_send_halfword(uint16_t half_word)
 
 void spi_flash_write_enable(void)
 {
+    /* WREN is ignored while a previous erase/program is in progress */
+    spi_flash_wait_for_write_end();
+
     SPI_FLASH_CS_LOW();
     spi_flash_send_byte(WREN);
     SPI_FLASH_CS_HIGH();
 }
 
+uint8_t spi_flash_is_busy(void)
+{
+    uint8_t flash_status;
+
+    SPI_FLASH_CS_LOW();
+    spi_flash_send_byte(RDSR);
+    flash_status = spi_flash_send_byte(DUMMY_BYTE);
+    SPI_FLASH_CS_HIGH();
+
+    return (flash_status & WIP_FLAG) ? 1 : 0;
+}
+
 void spi_flash_wait_for_write_end(void)
 {
     uint8_t flash_status = 0;
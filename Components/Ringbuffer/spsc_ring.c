@@ -0,0 +1,150 @@
+#include "spsc_ring.h"
+#include <string.h>
+
+/**
+ * @brief Initialise a ring over a caller-provided pool.
+ * @param size pool size in bytes, must be a power of two
+ * @retval 0 on success, -1 if size is not a power of two
+ */
+int spsc_ring_init(spsc_ring_t *ring, uint8_t *pool, uint32_t size)
+{
+    if (size == 0 || (size & (size - 1)) != 0)
+        return -1;
+
+    ring->buffer = pool;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    return 0;
+}
+
+/**
+ * @brief Discard all data. Only safe while neither side is active.
+ */
+void spsc_ring_reset(spsc_ring_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * @brief Producer: get the contiguous free span at the write position.
+ * @param span receives a pointer into the ring
+ * @retval span length in bytes, 0 when the ring is full
+ */
+uint32_t spsc_ring_reserve(spsc_ring_t *ring, uint8_t **span)
+{
+    uint32_t head = ring->head;
+    uint32_t free = spsc_ring_size(ring) - (head - ring->tail);
+    uint32_t offset = head & ring->mask;
+    uint32_t to_end = spsc_ring_size(ring) - offset;
+
+    /* the consumer's tail read must complete before we overwrite its slots */
+    SPSC_RING_BARRIER();
+    *span = &ring->buffer[offset];
+    return free < to_end ? free : to_end;
+}
+
+/**
+ * @brief Producer: publish length bytes written into the reserved span.
+ */
+void spsc_ring_commit(spsc_ring_t *ring, uint32_t length)
+{
+    SPSC_RING_BARRIER();
+    ring->head += length;
+}
+
+/**
+ * @brief Producer: copy data in, wrapping as needed.
+ * @retval bytes written, less than length when the ring fills
+ */
+uint32_t spsc_ring_write(spsc_ring_t *ring, const uint8_t *data, uint32_t length)
+{
+    uint32_t done = 0;
+    uint8_t *span;
+
+    while (done < length)
+    {
+        uint32_t n = spsc_ring_reserve(ring, &span);
+        if (n == 0)
+            break;
+        if (n > length - done)
+            n = length - done;
+        memcpy(span, data + done, n);
+        done += n;
+        spsc_ring_commit(ring, n);
+    }
+    return done;
+}
+
+/**
+ * @brief Consumer: get the contiguous readable span at the read position.
+ * @param span receives a pointer into the ring
+ * @retval span length in bytes, 0 when the ring is empty
+ */
+uint32_t spsc_ring_acquire(spsc_ring_t *ring, uint8_t **span)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t to_end = spsc_ring_size(ring) - offset;
+
+    /* the head read must complete before the data it publishes is read */
+    SPSC_RING_BARRIER();
+    *span = &ring->buffer[offset];
+    return used < to_end ? used : to_end;
+}
+
+/**
+ * @brief Consumer: hand length bytes of the acquired span back to the producer.
+ */
+void spsc_ring_release(spsc_ring_t *ring, uint32_t length)
+{
+    SPSC_RING_BARRIER();
+    ring->tail += length;
+}
+
+/**
+ * @brief Consumer: copy data out, wrapping as needed.
+ * @retval bytes read
+ */
+uint32_t spsc_ring_read(spsc_ring_t *ring, uint8_t *data, uint32_t length)
+{
+    uint32_t done = 0;
+    uint8_t *span;
+
+    while (done < length)
+    {
+        uint32_t n = spsc_ring_acquire(ring, &span);
+        if (n == 0)
+            break;
+        if (n > length - done)
+            n = length - done;
+        memcpy(data + done, span, n);
+        done += n;
+        spsc_ring_release(ring, n);
+    }
+    return done;
+}
+
+/**
+ * @brief Consumer: copy data out without releasing it, wrapping as needed.
+ * @retval bytes copied, less than length when the ring holds less
+ */
+uint32_t spsc_ring_peek(spsc_ring_t *ring, uint8_t *data, uint32_t length)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t first;
+
+    SPSC_RING_BARRIER();
+    if (length > used)
+        length = used;
+    first = spsc_ring_size(ring) - offset;
+    if (first > length)
+        first = length;
+    memcpy(data, &ring->buffer[offset], first);
+    memcpy(data + first, ring->buffer, length - first);
+    return length;
+}
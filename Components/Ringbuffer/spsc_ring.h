@@ -0,0 +1,73 @@
+#ifndef SPSC_RING_H__
+#define SPSC_RING_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+
+/*
+ * Single-producer single-consumer byte ring.
+ *
+ * - size is a power of two; head/tail are free-running 32-bit counters,
+ *   so used = head - tail with no mirror bit and no wasted slot.
+ * - head is written only by the producer, tail only by the consumer.
+ *   Either side may run in an ISR; a barrier orders the data access
+ *   before the index update that publishes it.
+ * - reserve/commit (producer) and acquire/release (consumer) expose the
+ *   ring memory directly as contiguous spans, so DMA engines and parsers
+ *   work in place. A span never wraps; the second half of a wrapped
+ *   region is returned by the next call.
+ */
+
+#if defined(__CC_ARM)
+#define SPSC_RING_BARRIER() __dmb(0xF)
+#elif defined(__GNUC__) || defined(__clang__)
+#define SPSC_RING_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#error "spsc_ring: no memory barrier for this compiler"
+#endif
+
+typedef struct
+{
+    uint8_t *buffer;
+    uint32_t mask;
+    volatile uint32_t head; /* producer index */
+    volatile uint32_t tail; /* consumer index */
+} spsc_ring_t;
+
+int spsc_ring_init(spsc_ring_t *ring, uint8_t *pool, uint32_t size);
+void spsc_ring_reset(spsc_ring_t *ring);
+
+/* producer side */
+uint32_t spsc_ring_reserve(spsc_ring_t *ring, uint8_t **span);
+void spsc_ring_commit(spsc_ring_t *ring, uint32_t length);
+uint32_t spsc_ring_write(spsc_ring_t *ring, const uint8_t *data, uint32_t length);
+
+/* consumer side */
+uint32_t spsc_ring_acquire(spsc_ring_t *ring, uint8_t **span);
+void spsc_ring_release(spsc_ring_t *ring, uint32_t length);
+uint32_t spsc_ring_read(spsc_ring_t *ring, uint8_t *data, uint32_t length);
+uint32_t spsc_ring_peek(spsc_ring_t *ring, uint8_t *data, uint32_t length);
+
+static inline uint32_t spsc_ring_size(const spsc_ring_t *ring)
+{
+    return ring->mask + 1;
+}
+
+static inline uint32_t spsc_ring_used(const spsc_ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t spsc_ring_free(const spsc_ring_t *ring)
+{
+    return spsc_ring_size(ring) - spsc_ring_used(ring);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -59,10 +59,13 @@ void DMA1_Stream5_IRQHandler(void);
 void ADC_IRQHandler(void);
 void USART1_IRQHandler(void);
 void TIM8_TRG_COM_TIM14_IRQHandler(void);
+void SDIO_IRQHandler(void);
 void DMA2_Stream0_IRQHandler(void);
 void DMA2_Stream2_IRQHandler(void);
+void DMA2_Stream3_IRQHandler(void);
+void DMA2_Stream6_IRQHandler(void);
 /* USER CODE BEGIN EFP */
-
+void PVD_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
@@ -117,7 +117,7 @@ int main(void)
   MX_FATFS_Init();
   MX_RTC_Init();
   /* USER CODE BEGIN 2 */
-  rt_ringbuffer_init(&uart_ringbuffer, ringbuffer_pool, sizeof(ringbuffer_pool));
+  uart_rx_init();
  // app_btn_init();
   OLED_Init();
   adc_tim_dma_init();
@@ -128,6 +128,8 @@ int main(void)
   device_id_init();
   sampling_init();  
   data_storage_init(); 
+  sample_bus_subscribe(handle_sampling_output);
+  config_set_save_callback(handle_config_saved);
   scheduler_init();
   sampling_set_cycle(CYCLE_5S);
   
@@ -135,6 +137,10 @@ int main(void)
 
   data_storage_write_log("system init");
 
+#if APP_USE_RTOS
+  app_threads_start();
+#endif
+
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -21,7 +21,7 @@
 #include "tim.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "ring_bench.h"
 /* USER CODE END 0 */
 
 TIM_HandleTypeDef htim3;
@@ -212,5 +212,14 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* tim_baseHandle)
 }
 
 /* USER CODE BEGIN 1 */
-
+/**
+  * @brief Update interrupt dispatch: each timer's handler is called by instance.
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM14)
+  {
+    ring_bench_timer_isr();
+  }
+}
 /* USER CODE END 1 */
@@ -18,7 +18,9 @@
 /* USER CODE END Header */
 
 /* Note: code generation based on sd_diskio_template_bspv1.c v2.1.4
-   as "Use dma template" is disabled. */
+   as "Use dma template" is disabled.
+   Read/write are reworked in the user sections below to use the BSP DMA
+   variants with completion callbacks (see sd_diskio_dma_template_bspv1.c). */
 
 /* USER CODE BEGIN firstSection */
 /* can be used to modify / undefine following code or add new definitions */
@@ -27,6 +29,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "ff_gen_drv.h"
 #include "sd_diskio.h"
+#include <string.h>
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -41,6 +44,13 @@
 
 #define SD_DEFAULT_BLOCK_SIZE 512
 
+/* USER CODE BEGIN dmaDefines */
+/* timeout for one DMA transfer and for the card to return to transfer state */
+#define SD_DMA_TIMEOUT 1000
+/* sectors staged through the aligned scratch buffer per DMA transfer */
+#define SD_SCRATCH_SECTORS 4
+/* USER CODE END dmaDefines */
+
 /*
  * Depending on the use case, the SD card initialization could be done at the
  * application level: if it is the case define the flag below to disable
@@ -55,6 +65,20 @@
 /* Disk status */
 static volatile DSTATUS Stat = STA_NOINIT;
 
+/* USER CODE BEGIN dmaVariables */
+/* set from the SDIO/DMA interrupt when the current transfer finishes */
+static volatile UINT WriteStatus = 0, ReadStatus = 0, TransferError = 0;
+/* the SDIO DMA moves words: FatFs buffers that are not word aligned are
+   staged through this buffer */
+static __ALIGNED(4) BYTE scratch[SD_SCRATCH_SECTORS * SD_DEFAULT_BLOCK_SIZE];
+static sd_diskio_wait_t WaitHook = NULL;
+static sd_diskio_stats_t Stats;
+
+extern SD_HandleTypeDef hsd;
+extern DMA_HandleTypeDef hdma_sdio_rx;
+extern DMA_HandleTypeDef hdma_sdio_tx;
+/* USER CODE END dmaVariables */
+
 /* Private function prototypes -----------------------------------------------*/
 static DSTATUS SD_CheckStatus(BYTE lun);
 DSTATUS SD_initialize (BYTE);
@@ -87,6 +111,153 @@ const Diskio_drvTypeDef  SD_Driver =
 
 /* Private functions ---------------------------------------------------------*/
 
+/* USER CODE BEGIN dmaFunctions */
+/**
+  * @brief  Called repeatedly while a transfer is in flight
+  * @note   With no hook installed the core sleeps until the next interrupt
+  *         (the DMA completion interrupt or any other); an RTOS build can
+  *         install a hook that blocks the calling thread instead.
+  */
+static void SD_Wait(uint8_t can_sleep)
+{
+  if (WaitHook != NULL)
+  {
+    WaitHook();
+  }
+  else if (can_sleep)
+  {
+    __WFI();
+  }
+}
+
+/**
+  * @brief  Returns a DMA stream handle to READY
+  * @note   Stops a stream still marked busy; an abort that timed out leaves
+  *         the handle in the TIMEOUT state, which HAL_DMA_Start_IT rejects
+  */
+static void SD_ResetDma(DMA_HandleTypeDef *hdma)
+{
+  if (hdma->State == HAL_DMA_STATE_BUSY)
+  {
+    HAL_DMA_Abort(hdma);
+  }
+  /* an interrupt-driven abort from the SD error path may still be running */
+  __HAL_DMA_DISABLE(hdma);
+  hdma->State = HAL_DMA_STATE_READY;
+  __HAL_UNLOCK(hdma);
+}
+
+/**
+  * @brief  Abandons a failed or timed out transfer
+  * @note   HAL_SD_Abort stops the data path, aborts the DMA stream of the
+  *         current transfer, ends a pending multi-block command and puts the
+  *         handle back to READY. Both streams are then forced to READY so the
+  *         next BSP_SD_ReadBlocks_DMA/WriteBlocks_DMA can start; HAL_SD_Init
+  *         on remount does not reset them.
+  */
+static void SD_AbortTransfer(void)
+{
+  HAL_SD_Abort(&hsd);
+  SD_ResetDma(&hdma_sdio_rx);
+  SD_ResetDma(&hdma_sdio_tx);
+  hsd.State = HAL_SD_STATE_READY;
+  hsd.Context = SD_CONTEXT_NONE;
+  ReadStatus = 0;
+  WriteStatus = 0;
+  TransferError = 0;
+}
+
+/**
+  * @brief  Waits for the DMA completion flag, then for the card to leave
+  *         the receiving/programming state
+  * @note   Every error or timeout exit aborts the transfer
+  * @retval 0 on success, -1 on error or timeout
+  */
+static int SD_WaitTransfer(volatile UINT *done)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (*done == 0 && TransferError == 0)
+  {
+    if (HAL_GetTick() - start >= SD_DMA_TIMEOUT)
+    {
+      SD_AbortTransfer();
+      return -1;
+    }
+    SD_Wait(1);
+  }
+  if (TransferError)
+  {
+    SD_AbortTransfer();
+    return -1;
+  }
+
+  /* no interrupt marks the end of card programming: poll the card state */
+  start = HAL_GetTick();
+  while (BSP_SD_GetCardState() != SD_TRANSFER_OK)
+  {
+    if (HAL_GetTick() - start >= SD_DMA_TIMEOUT)
+    {
+      SD_AbortTransfer();
+      return -1;
+    }
+    SD_Wait(0);
+  }
+  Stats.busy_ms += HAL_GetTick() - start;
+
+  return 0;
+}
+
+/**
+  * @brief  One DMA read of count sectors into a word aligned buffer
+  */
+static DRESULT SD_ReadAligned(BYTE *buff, DWORD sector, UINT count)
+{
+  ReadStatus = 0;
+  TransferError = 0;
+  if (BSP_SD_ReadBlocks_DMA((uint32_t *)buff, (uint32_t)sector, count) != MSD_OK)
+  {
+    SD_AbortTransfer();
+    return RES_ERROR;
+  }
+  Stats.transfers++;
+  return SD_WaitTransfer(&ReadStatus) == 0 ? RES_OK : RES_ERROR;
+}
+
+/**
+  * @brief  One DMA write of count sectors from a word aligned buffer
+  */
+static DRESULT SD_WriteAligned(const BYTE *buff, DWORD sector, UINT count)
+{
+  WriteStatus = 0;
+  TransferError = 0;
+  if (BSP_SD_WriteBlocks_DMA((uint32_t *)buff, (uint32_t)sector, count) != MSD_OK)
+  {
+    SD_AbortTransfer();
+    return RES_ERROR;
+  }
+  Stats.transfers++;
+  return SD_WaitTransfer(&WriteStatus) == 0 ? RES_OK : RES_ERROR;
+}
+
+/**
+  * @brief  Installs the function called while a transfer is in flight
+  * @param  hook: NULL to sleep with WFI
+  */
+void sd_diskio_set_wait_hook(sd_diskio_wait_t hook)
+{
+  WaitHook = hook;
+}
+
+/**
+  * @brief  Returns transfer statistics
+  */
+void sd_diskio_get_stats(sd_diskio_stats_t *stats)
+{
+  *stats = Stats;
+}
+/* USER CODE END dmaFunctions */
+
 static DSTATUS SD_CheckStatus(BYTE lun)
 {
   Stat = STA_NOINIT;
@@ -146,19 +317,35 @@ DSTATUS SD_status(BYTE lun)
 
 DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 {
-  DRESULT res = RES_ERROR;
+  DRESULT res = RES_OK;
 
-  if(BSP_SD_ReadBlocks((uint32_t*)buff,
-                       (uint32_t) (sector),
-                       count, SD_TIMEOUT) == MSD_OK)
+  if (((uint32_t)buff & 3U) == 0)
+  {
+    /* aligned buffer: one multi-block transfer straight into it */
+    res = SD_ReadAligned(buff, sector, count);
+  }
+  else
   {
-    /* wait until the read operation is finished */
-    while(BSP_SD_GetCardState()!= MSD_OK)
+    /* unaligned buffer: read through the scratch buffer */
+    while (count > 0 && res == RES_OK)
     {
+      UINT n = count < SD_SCRATCH_SECTORS ? count : SD_SCRATCH_SECTORS;
+      res = SD_ReadAligned(scratch, sector, n);
+      if (res == RES_OK)
+      {
+        memcpy(buff, scratch, n * SD_DEFAULT_BLOCK_SIZE);
+        buff += n * SD_DEFAULT_BLOCK_SIZE;
+        sector += n;
+        count -= n;
+        Stats.unaligned++;
+      }
     }
-    res = RES_OK;
   }
 
+  if (res != RES_OK)
+  {
+    Stats.errors++;
+  }
   return res;
 }
 
@@ -177,19 +364,32 @@ DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 
 DRESULT SD_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
 {
-  DRESULT res = RES_ERROR;
+  DRESULT res = RES_OK;
 
-  if(BSP_SD_WriteBlocks((uint32_t*)buff,
-                        (uint32_t)(sector),
-                        count, SD_TIMEOUT) == MSD_OK)
+  if (((uint32_t)buff & 3U) == 0)
+  {
+    /* aligned buffer: one multi-block transfer straight from it */
+    res = SD_WriteAligned(buff, sector, count);
+  }
+  else
   {
-	/* wait until the Write operation is finished */
-    while(BSP_SD_GetCardState() != MSD_OK)
+    /* unaligned buffer: write through the scratch buffer */
+    while (count > 0 && res == RES_OK)
     {
+      UINT n = count < SD_SCRATCH_SECTORS ? count : SD_SCRATCH_SECTORS;
+      memcpy(scratch, buff, n * SD_DEFAULT_BLOCK_SIZE);
+      res = SD_WriteAligned(scratch, sector, n);
+      buff += n * SD_DEFAULT_BLOCK_SIZE;
+      sector += n;
+      count -= n;
+      Stats.unaligned++;
     }
-    res = RES_OK;
   }
 
+  if (res != RES_OK)
+  {
+    Stats.errors++;
+  }
   return res;
 }
 #endif /* _USE_WRITE == 1 */
@@ -254,4 +454,27 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new code */
+/**
+  * @brief Tx Transfer completed callback
+  */
+void BSP_SD_WriteCpltCallback(void)
+{
+  WriteStatus = 1;
+}
+
+/**
+  * @brief Rx Transfer completed callback
+  */
+void BSP_SD_ReadCpltCallback(void)
+{
+  ReadStatus = 1;
+}
+
+/**
+  * @brief SD error callback: ends the wait early instead of timing out
+  */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+  TransferError = 1;
+}
 /* USER CODE END lastSection */
@@ -36,6 +36,19 @@ extern const Diskio_drvTypeDef  SD_Driver;
 
 /* USER CODE BEGIN lastSection */
 /* can be used to modify / undefine previous code or add new definitions */
+/* called repeatedly while an SD DMA transfer is in flight */
+typedef void (*sd_diskio_wait_t)(void);
+
+typedef struct
+{
+  uint32_t transfers;  /* DMA transfers started */
+  uint32_t unaligned;  /* transfers staged through the scratch buffer */
+  uint32_t errors;     /* failed or timed out read/write calls */
+  uint32_t busy_ms;    /* time spent polling for the card to finish programming */
+} sd_diskio_stats_t;
+
+void sd_diskio_set_wait_hook(sd_diskio_wait_t hook);
+void sd_diskio_get_stats(sd_diskio_stats_t *stats);
 /* USER CODE END lastSection */
 
 #endif /* __SD_DISKIO_H */
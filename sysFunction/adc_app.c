@@ -1,4 +1,9 @@
 #include "adc_app.h"
+#include "adc_reduce.h"
+#include "adc_decimate.h"
+#include "adc_spectrum.h"
+#include "adc_harmonic.h"
+#include "adc_trigger.h"
 #include "tim.h"
 
 #define ADC_MODE (3)
@@ -29,7 +34,7 @@ void adc_task(void)
 #elif ADC_MODE == 2
 
 #define ADC_DMA_BUFFER_SIZE 32
-uint32_t adc_dma_buffer[ADC_DMA_BUFFER_SIZE];
+uint16_t adc_dma_buffer[ADC_DMA_BUFFER_SIZE];
 __IO uint32_t adc_val;
 __IO float voltage;
 
@@ -54,62 +59,475 @@ void adc_task(void)
     my_printf(&huart1, "Average ADC: %lu, Voltage: %.2fV\n", adc_val, voltage);
 }
 
-// ADC模式3：双通道DMA采样
+// ADC模式3：多通道循环DMA采样（双缓冲，半区处理）
 #elif ADC_MODE == 3
 
-#define BUFFER_SIZE 2048
+#define HALF_BUFFER_SIZE ADC_BLOCK_SAMPLES
+#define BUFFER_SIZE (HALF_BUFFER_SIZE * 2)
+
+#define ADC_BLOCK_FIRST 0x01  // 前半区就绪
+#define ADC_BLOCK_SECOND 0x02 // 后半区就绪
+
+#define ADC_RATE_MIN 10    // TIM3触发频率下限(Hz)
+#define ADC_RATE_MAX 40000 // 上限：半区周期需大于块处理耗时
+
+// 块就绪事件：DMA中断入队并挂起低优先级事件中断，在其中立即处理数据块。
+// 借用未使用的DMA2D中断向量作软件中断，优先级最低，不阻塞DMA/串口/时基中断。
+// RTOS模式下改为唤醒采集线程，由线程处理数据块。
+#define ADC_EVENT_QUEUE_LEN 4 // 2的幂
+#define ADC_EVENT_IRQn DMA2D_IRQn
+#define ADC_EVENT_IRQHandler DMA2D_IRQHandler
+#define ADC_EVENT_IRQ_PRIORITY 15
+
+typedef struct
+{
+    uint8_t block;        // ADC_BLOCK_FIRST/ADC_BLOCK_SECOND
+    uint32_t post_cycles; // 入队时DWT周期计数，用于统计处理延迟
+} adc_event_t;
+
+typedef struct
+{
+    uint32_t channel;   
+    GPIO_TypeDef *port; 
+    uint16_t pin;       
+} adc_channel_map_t;
+
+// 扫描顺序通道表，前ADC_CHANNEL_COUNT项依次作为规则组rank1..N
+static const adc_channel_map_t adc_channel_map[ADC_CHANNEL_MAX] = {
+    {ADC_CHANNEL_10, GPIOC, GPIO_PIN_0},
+    {ADC_CHANNEL_5, GPIOA, GPIO_PIN_5},
+    {ADC_CHANNEL_11, GPIOC, GPIO_PIN_1},
+    {ADC_CHANNEL_12, GPIOC, GPIO_PIN_2},
+    {ADC_CHANNEL_13, GPIOC, GPIO_PIN_3},
+    {ADC_CHANNEL_14, GPIOC, GPIO_PIN_4},
+    {ADC_CHANNEL_15, GPIOC, GPIO_PIN_5},
+    {ADC_CHANNEL_8, GPIOB, GPIO_PIN_0}};
 
 extern DMA_HandleTypeDef hdma_adc1;
 
-uint32_t dac_val_buffer[BUFFER_SIZE / 2];
-uint32_t res_val_buffer[BUFFER_SIZE / 2];
-__IO uint32_t adc_val_buffer[BUFFER_SIZE];
+// 半字DMA，12位采样按16位存储；按字读取的SIMD归约要求4字节对齐
+__ALIGNED(4) __IO uint16_t adc_val_buffer[BUFFER_SIZE];
+adc_channel_stats_t adc_stats[ADC_CHANNEL_COUNT];
+adc_decimate_result_t adc_decimate_results[ADC_CHANNEL_COUNT];
+uint32_t adc_decimate_cycles = 0;
+adc_wave_stats_t adc_wave[ADC_CHANNEL_COUNT];
+adc_harmonic_result_t adc_harmonic[ADC_CHANNEL_COUNT];
+uint32_t adc_harmonic_cycles = 0;
+uint32_t adc_block_cycles = 0; // 整个数据块处理的周期数
+__IO float adc_voltage[ADC_CHANNEL_COUNT];
 __IO float voltage;
-__IO uint8_t AdcConvEnd = 0;
+__IO uint8_t adc_block_ready = 0;
+__IO uint8_t adc_block_latest = 0;
+__IO uint32_t adc_dropped_blocks = 0;
+static uint32_t adc_requested_rate = 0; // 最近一次设置的目标采样率，0为沿用TIM3初始化的频率
+static adc_event_t adc_event_queue[ADC_EVENT_QUEUE_LEN];
+static __IO uint8_t adc_event_head = 0; // 仅DMA中断写
+static __IO uint8_t adc_event_tail = 0; // 仅事件中断写
+__IO uint32_t adc_event_overflow = 0;
+uint32_t adc_event_latency_last = 0;
+uint32_t adc_event_latency_max = 0;
 uint8_t wave_analysis_flag = 0;
 uint8_t wave_query_type = 0;
 
-// ADC+定时器+DMA初始化
+// 按通道表重新配置ADC1扫描序列
+static void adc_channel_init(void)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+
+    hadc1.Init.NbrOfConversion = ADC_CHANNEL_COUNT;
+    hadc1.Init.ScanConvMode = (ADC_CHANNEL_COUNT > 1) ? ENABLE : DISABLE;
+    if (HAL_ADC_Init(&hadc1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    sConfig.SamplingTime = ADC_SAMPLETIME_3CYCLES;
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        GPIO_InitStruct.Pin = adc_channel_map[ch].pin;
+        HAL_GPIO_Init(adc_channel_map[ch].port, &GPIO_InitStruct);
+
+        sConfig.Channel = adc_channel_map[ch].channel;
+        sConfig.Rank = ch + 1;
+        if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+        {
+            Error_Handler();
+        }
+    }
+}
+
+// ADC+定时器+DMA初始化，DMA循环运行，不再逐块停止重启
 void adc_tim_dma_init(void)
 {
-    HAL_TIM_Base_Start(&htim3);
+    adc_block_ready = 0;
+    adc_dropped_blocks = 0;
+    adc_event_head = adc_event_tail = 0;
+    adc_channel_init();
+    adc_decimate_reset();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+#if !APP_USE_RTOS
+    HAL_NVIC_SetPriority(ADC_EVENT_IRQn, ADC_EVENT_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(ADC_EVENT_IRQn);
+#endif
+
     HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_val_buffer, BUFFER_SIZE);
-    __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_HT);
+    HAL_TIM_Base_Start(&htim3);
 }
 
-// ADC转换完成回调
+// 半区就绪：登记并入队，挂起事件中断；上一轮同一半区未处理完即记为丢块，队列满记为溢出
+static void adc_block_post(uint8_t block)
+{
+    uint8_t head = adc_event_head;
+
+    if (adc_block_ready & block)
+    {
+        adc_dropped_blocks++;
+    }
+    adc_block_ready |= block;
+    adc_block_latest = block;
+
+    if ((uint8_t)(head - adc_event_tail) >= ADC_EVENT_QUEUE_LEN)
+    {
+        adc_event_overflow++;
+    }
+    else
+    {
+        adc_event_queue[head & (ADC_EVENT_QUEUE_LEN - 1)].block = block;
+        adc_event_queue[head & (ADC_EVENT_QUEUE_LEN - 1)].post_cycles = DWT->CYCCNT;
+        adc_event_head = head + 1;
+    }
+#if APP_USE_RTOS
+    app_notify_acq_from_isr();
+#else
+    NVIC_SetPendingIRQ(ADC_EVENT_IRQn);
+#endif
+}
+
+// 屏蔽/恢复事件中断，主循环读取块处理结果或改动采集状态时使用；RTOS模式下为采集互斥锁
+void adc_event_lock(void)
+{
+#if APP_USE_RTOS
+    app_acq_lock();
+#else
+    HAL_NVIC_DisableIRQ(ADC_EVENT_IRQn);
+#endif
+}
+
+void adc_event_unlock(void)
+{
+#if APP_USE_RTOS
+    app_acq_unlock();
+#else
+    HAL_NVIC_EnableIRQ(ADC_EVENT_IRQn);
+#endif
+}
+
+// ADC半传输回调：前半区填满，DMA继续写后半区
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc == &hadc1)
+    {
+        adc_block_post(ADC_BLOCK_FIRST);
+    }
+}
+
+// ADC转换完成回调：后半区填满，DMA绕回前半区
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
-    UNUSED(hadc);
     if (hadc == &hadc1)
     {
-        HAL_ADC_Stop_DMA(hadc);
-        AdcConvEnd = 1;
+        adc_block_post(ADC_BLOCK_SECOND);
     }
 }
 
-// ADC任务
-void adc_task(void)
+// 获取丢块计数
+uint32_t adc_get_dropped_blocks(void)
+{
+    return adc_dropped_blocks;
+}
+
+// 获取通道电压（未乘变比）
+float adc_get_voltage(uint8_t channel)
+{
+    if (channel >= ADC_CHANNEL_COUNT)
+        return 0.0f;
+    return adc_voltage[channel];
+}
+
+// 获取通道最近一个数据块的谐波分析结果（幅值为电压，未乘变比），通道越界返回0
+uint8_t adc_get_harmonics(uint8_t channel, adc_harmonic_result_t *result)
+{
+    if (channel >= ADC_CHANNEL_COUNT || result == NULL)
+        return 0;
+    adc_event_lock();
+    *result = adc_harmonic[channel];
+    adc_event_unlock();
+    for (uint8_t h = 0; h < result->count; h++)
+    {
+        result->amp[h] *= ADC_CODE_TO_VOLT;
+    }
+    return 1;
+}
+
+// 数据块处理每块CPU开销（周期数），尚未处理过数据块时为0
+uint32_t adc_get_block_cycles(void)
+{
+    return adc_block_cycles;
+}
+
+// 谐波分析每块CPU开销（周期数）
+uint32_t adc_get_harmonic_cycles(void)
+{
+    return adc_harmonic_cycles;
+}
+
+// 获取通道最近一个数据块的波形参数（未乘变比），通道越界返回0
+uint8_t adc_get_wave_stats(uint8_t channel, adc_wave_stats_t *wave)
+{
+    if (channel >= ADC_CHANNEL_COUNT || wave == NULL)
+        return 0;
+    adc_event_lock();
+    *wave = adc_wave[channel];
+    adc_event_unlock();
+    return 1;
+}
+
+// TIM3计数时钟：APB1分频不为1时定时器时钟为PCLK1的2倍
+static uint32_t adc_tim_clock(void)
 {
-    if (AdcConvEnd)
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_HCLK_DIV1) ? pclk1 : pclk1 * 2;
+}
+
+// 获取当前采样（帧）频率
+uint32_t adc_get_sample_rate(void)
+{
+    return adc_tim_clock() / ((htim3.Instance->PSC + 1) * (htim3.Instance->ARR + 1));
+}
+
+// 获取目标采样率：切换时钟档位后按此值重算分频，实际频率的取整误差不会累积
+uint32_t adc_get_requested_rate(void)
+{
+    return adc_requested_rate ? adc_requested_rate : adc_get_sample_rate();
+}
+
+// 采样率是否在TIM3可设置范围内
+uint8_t adc_sample_rate_valid(uint32_t rate_hz)
+{
+    return rate_hz >= ADC_RATE_MIN && rate_hz <= ADC_RATE_MAX;
+}
+
+// 重新设置TIM3触发频率并记为目标采样率，返回实际频率，参数越界返回0
+uint32_t adc_set_sample_rate(uint32_t rate_hz)
+{
+    if (!adc_sample_rate_valid(rate_hz))
+    {
+        return 0;
+    }
+    adc_requested_rate = rate_hz;
+
+    uint32_t ticks = adc_tim_clock() / rate_hz;
+    uint32_t psc = (ticks - 1) / 65536 + 1;
+    uint32_t arr = ticks / psc;
+
+    HAL_TIM_Base_Stop(&htim3);
+    htim3.Init.Prescaler = psc - 1;
+    htim3.Init.Period = arr - 1;
+    __HAL_TIM_SET_PRESCALER(&htim3, psc - 1);
+    __HAL_TIM_SET_AUTORELOAD(&htim3, arr - 1);
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    // PSC为预装载寄存器，产生更新事件使其立即生效
+    htim3.Instance->EGR = TIM_EGR_UG;
+    adc_event_lock();
+    adc_decimate_reset();
+    adc_event_unlock();
+    HAL_TIM_Base_Start(&htim3);
+
+    return adc_get_sample_rate();
+}
+
+// 处理一个半区数据块：单遍解交织并归约全部通道，再做CIC抽取
+static void adc_process_block(const __IO uint16_t *block)
+{
+    uint32_t rate = adc_get_sample_rate();
+    uint32_t block_start = DWT->CYCCNT;
+
+    adc_reduce(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, adc_stats);
+    adc_trigger_push(block, adc_stats, rate);
+
+    uint32_t start = DWT->CYCCNT;
+    adc_decimate_block(block, ADC_BLOCK_FRAMES, adc_decimate_results);
+    adc_decimate_cycles = DWT->CYCCNT - start;
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
     {
-        for (uint16_t i = 0; i < BUFFER_SIZE / 2; i++)
+        // 均值保留小数位，不再截断为整数码值
+        float avg = (adc_decimate_results[ch].count > 0) ? adc_decimate_results[ch].mean
+                                                         : (float)adc_stats[ch].sum / adc_stats[ch].count;
+        adc_voltage[ch] = avg * ADC_CODE_TO_VOLT;
+        adc_wave_from_stats(&adc_stats[ch], ADC_CODE_TO_VOLT, &adc_wave[ch]);
+    }
+    voltage = adc_voltage[0];
+
+    start = DWT->CYCCNT;
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float mean = (float)adc_stats[ch].sum / adc_stats[ch].count;
+        adc_harmonic_block(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, ch, mean, (float)rate, &adc_harmonic[ch]);
+    }
+    adc_harmonic_cycles = DWT->CYCCNT - start;
+    adc_block_cycles = DWT->CYCCNT - block_start;
+}
+
+// 打印采样率、抽取配置、各通道噪声估算的有效位数与抽取CPU开销
+// 有效位数由块内标准差换算，标准差含信号本身，仅在输入为直流或短接时代表噪声
+void adc_rate_report(void)
+{
+    uint32_t rate = adc_get_sample_rate();
+    uint16_t ratio = adc_decimate_get_ratio();
+    uint32_t block_cycles = (uint32_t)((uint64_t)ADC_BLOCK_FRAMES * SystemCoreClock / rate);
+
+    my_printf(&huart1, "sample rate: %lu Hz\r\n", rate);
+    my_printf(&huart1, "decimation: %d (CIC%d) -> %.1f Hz\r\n", ratio, ADC_CIC_ORDER, (float)rate / ratio);
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float raw_std = adc_wave[ch].std_dev / ADC_CODE_TO_VOLT;
+        my_printf(&huart1, "ch%d noise ENOB (DC/shorted input only): raw %.2f, decimated %.2f\r\n", ch,
+                  adc_enob_from_std(raw_std), adc_enob_from_std(adc_decimate_results[ch].std_dev));
+    }
+    my_printf(&huart1, "decimation cpu: %lu cycles/block (%.2f%%)\r\n",
+              adc_decimate_cycles, 100.0f * adc_decimate_cycles / block_cycles);
+    my_printf(&huart1, "block latency: last %.1f us, max %.1f us\r\n",
+              adc_event_latency_last * 1e6f / SystemCoreClock, adc_event_latency_max * 1e6f / SystemCoreClock);
+    my_printf(&huart1, "block events: dropped %lu, queue overflow %lu\r\n", adc_dropped_blocks, adc_event_overflow);
+}
+
+// 频谱分析：采集不停止，从最近完成的半区拷出指定通道后做FFT。DMA此时写另一半区，
+// 拷贝期间若又完成一个半区（数据源开始被改写）则重拷。采集缓冲不能再作工作区，
+// 工作区借用预触发环形缓冲，突发记录进行中时返回0
+uint8_t adc_spectrum_capture(uint8_t channel, adc_spectrum_result_t *result)
+{
+    uint32_t rate = adc_get_sample_rate();
+    uint16_t fft_len = adc_spectrum_fft_len(ADC_BLOCK_FRAMES, ADC_BLOCK_FRAMES);
+    uint8_t latest, ok;
+
+    if (channel >= ADC_CHANNEL_COUNT || adc_block_latest == 0 || fft_len == 0)
+    {
+        return 0;
+    }
+
+    // 工作区布局：FFT输入、FFT输出(各fft_len个float)，其后为拷出的通道采样
+    float *work_in = adc_trigger_borrow_ring(fft_len * (2 * sizeof(float) + sizeof(uint16_t)));
+    if (work_in == NULL)
+    {
+        return 0;
+    }
+    float *work_out = work_in + fft_len;
+    uint16_t *samples = (uint16_t *)(work_out + fft_len);
+
+    do
+    {
+        latest = adc_block_latest;
+        const __IO uint16_t *block =
+            (latest == ADC_BLOCK_FIRST) ? &adc_val_buffer[0] : &adc_val_buffer[HALF_BUFFER_SIZE];
+        for (uint16_t i = 0; i < fft_len; i++)
         {
-            dac_val_buffer[i] = adc_val_buffer[i * 2 + 1];
-            res_val_buffer[i] = adc_val_buffer[i * 2];
+            samples[i] = block[(uint32_t)i * ADC_CHANNEL_COUNT + channel];
         }
-        uint32_t res_sum = 0;
-        for (uint16_t i = 0; i < BUFFER_SIZE / 2; i++)
+    } while (adc_block_latest != latest);
+
+    ok = adc_spectrum_run(samples, 1, 0, fft_len, work_in, work_out, (float)rate, ADC_CODE_TO_VOLT, result);
+    adc_trigger_return_ring();
+    return ok;
+}
+
+// 归约内核基准测试：在最近完成的半区上对比标量与SIMD实现的每采样周期数
+void adc_reduce_benchmark(void)
+{
+    static adc_channel_stats_t ref[ADC_CHANNEL_COUNT], simd[ADC_CHANNEL_COUNT];
+    const __IO uint16_t *block = (adc_block_latest == ADC_BLOCK_FIRST) ? &adc_val_buffer[0] : &adc_val_buffer[HALF_BUFFER_SIZE];
+    uint32_t samples = HALF_BUFFER_SIZE;
+    uint8_t match = 1;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t start = DWT->CYCCNT;
+    adc_reduce_ref(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, ref);
+    uint32_t ref_cycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    adc_reduce(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, simd);
+    uint32_t simd_cycles = DWT->CYCCNT - start;
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        if (ref[ch].sum != simd[ch].sum || ref[ch].sum_sq != simd[ch].sum_sq ||
+            ref[ch].min != simd[ch].min || ref[ch].max != simd[ch].max)
         {
-            res_sum += res_val_buffer[i];
+            match = 0;
         }
+    }
 
-        uint32_t res_avg = res_sum / (BUFFER_SIZE / 2);
-        voltage = (float)res_avg * 3.3f / 4096.0f;
-        AdcConvEnd = 0;
+    my_printf(&huart1, "ADC reduce bench: %lu samples, %d channels\r\n", samples, ADC_CHANNEL_COUNT);
+    my_printf(&huart1, "scalar: %lu cycles (%.2f cycles/sample)\r\n", ref_cycles, (float)ref_cycles / samples);
+    my_printf(&huart1, "simd:   %lu cycles (%.2f cycles/sample)\r\n", simd_cycles, (float)simd_cycles / samples);
+    my_printf(&huart1, "result %s\r\n", match ? "match" : "MISMATCH");
+}
 
-        HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_val_buffer, BUFFER_SIZE);
-        __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_HT);
+// 按入队顺序处理数据块，处理完成后才清除就绪位；裸机模式在事件中断中调用，RTOS模式在采集线程中调用
+void adc_event_drain(void)
+{
+    while (adc_event_tail != adc_event_head)
+    {
+        uint8_t tail = adc_event_tail;
+        adc_event_t event = adc_event_queue[tail & (ADC_EVENT_QUEUE_LEN - 1)];
+
+#if APP_USE_RTOS
+        adc_event_lock();
+#endif
+        adc_process_block(event.block == ADC_BLOCK_FIRST ? &adc_val_buffer[0] : &adc_val_buffer[HALF_BUFFER_SIZE]);
+#if APP_USE_RTOS
+        adc_event_unlock();
+#endif
+
+        __disable_irq();
+        adc_block_ready &= ~event.block;
+        __enable_irq();
+
+        adc_event_latency_last = DWT->CYCCNT - event.post_cycles;
+        if (adc_event_latency_last > adc_event_latency_max)
+        {
+            adc_event_latency_max = adc_event_latency_last;
+        }
+        adc_event_tail = tail + 1;
+    }
+}
+
+#if !APP_USE_RTOS
+// 块就绪事件中断
+void ADC_EVENT_IRQHandler(void)
+{
+    adc_event_drain();
+}
+#endif
+
+// ADC任务：数据块已在事件中断中处理，此处仅作兜底，队列非空时重新挂起事件中断
+void adc_task(void)
+{
+    if (adc_event_tail != adc_event_head)
+    {
+        NVIC_SetPendingIRQ(ADC_EVENT_IRQn);
     }
 }
 
@@ -3,10 +3,29 @@
 
 #include "stdint.h"  
 #include "mydefine.h" 
+#include "adc_channel.h"
+#include "adc_decimate.h"
+#include "adc_reduce.h"
+#include "adc_spectrum.h"
+#include "adc_harmonic.h"
+#include "adc_trigger.h"
 
 void adc_task(void);         
 void dac_sin_init(void);     
 void adc_dma_init(void);     
 void adc_tim_dma_init(void);
+uint32_t adc_get_dropped_blocks(void);
+float adc_get_voltage(uint8_t channel);
+uint8_t adc_get_wave_stats(uint8_t channel, adc_wave_stats_t *wave);
+uint8_t adc_get_harmonics(uint8_t channel, adc_harmonic_result_t *result);
+uint32_t adc_get_harmonic_cycles(void);
+uint32_t adc_get_block_cycles(void);
+uint8_t adc_sample_rate_valid(uint32_t rate_hz);
+uint32_t adc_set_sample_rate(uint32_t rate_hz);
+uint32_t adc_get_sample_rate(void);
+uint32_t adc_get_requested_rate(void);
+void adc_rate_report(void);
+uint8_t adc_spectrum_capture(uint8_t channel, adc_spectrum_result_t *result);
+void adc_reduce_benchmark(void);
 
 #endif 
@@ -0,0 +1,28 @@
+#ifndef __ADC_CHANNEL_H__
+#define __ADC_CHANNEL_H__
+
+// 采集通道数：ADC1规则组扫描序列长度，通道映射见adc_app.c中的adc_channel_map。
+// 默认单通道ch0(ADC_CHANNEL_10/PC0)，串口、隐藏格式、存储文件与config.ini输出与单通道版本一致；
+// 2..8通道为可选项，在工程预定义宏中指定(如ADC_CHANNEL_COUNT=2)，各输出格式随之追加ch1..chN列
+#ifndef ADC_CHANNEL_COUNT
+#define ADC_CHANNEL_COUNT 1
+#endif
+#define ADC_CHANNEL_MAX 8
+
+#if (ADC_CHANNEL_COUNT < 1) || (ADC_CHANNEL_COUNT > ADC_CHANNEL_MAX)
+#error "ADC_CHANNEL_COUNT must be 1..8"
+#endif
+
+// 每个DMA半区（数据块）的帧数，一帧为全部通道各一个采样，总缓冲约保持2048个半字
+#define ADC_BLOCK_FRAMES ((1024 / ADC_CHANNEL_COUNT) & ~1)
+#define ADC_BLOCK_SAMPLES (ADC_BLOCK_FRAMES * ADC_CHANNEL_COUNT)
+
+// 12位ADC，参考电压3.3V
+#define ADC_CODE_TO_VOLT (3.3f / 4096.0f)
+
+// 块处理互斥（实现见adc_app.c）：裸机模式屏蔽块事件中断，RTOS模式为采集互斥锁，不可嵌套。
+// 主循环/线程改动块处理读取的状态（抽取器、触发状态机）时使用
+void adc_event_lock(void);
+void adc_event_unlock(void);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __ADC_DECIMATE_H__
+#define __ADC_DECIMATE_H__
+
+#include "stdint.h"
+#include "adc_channel.h"
+
+#define ADC_CIC_ORDER 3         
+#define ADC_DECIMATE_MAX 64     // 12+3*log2(64)=30位，uint32累加器不溢出
+
+typedef struct
+{
+    uint32_t integ[ADC_CIC_ORDER]; 
+    uint32_t comb[ADC_CIC_ORDER];  
+} adc_cic_state_t;
+
+typedef struct
+{
+    float mean;      // 抽取输出均值（ADC码值，含小数位）
+    float std_dev;   // 抽取输出标准差（ADC码值）
+    uint32_t count;  // 本块抽取输出个数
+} adc_decimate_result_t;
+
+uint8_t adc_decimate_ratio_valid(uint32_t ratio);
+uint8_t adc_decimate_set_ratio(uint16_t ratio);                                                      
+uint16_t adc_decimate_get_ratio(void);                                                               
+void adc_decimate_reset(void);                                                                       
+void adc_decimate_block(const volatile uint16_t *block, uint32_t frames, adc_decimate_result_t *results); 
+float adc_enob_from_std(float std_dev);                                                              
+
+#endif
@@ -0,0 +1,96 @@
+#include "adc_harmonic.h"
+#include "arm_math.h"
+#include "string.h"
+
+// Goertzel谐波分析：每次谐波一个二阶IIR，只计算关心的频点，
+// 开销为 帧数*谐波数 次乘加，远低于整块FFT，可以每块运行。
+// 块长一般不是基波周期的整数倍，先加Hann窗抑制泄漏；窗函数用旋转递推生成，不占表格内存。
+
+static float g_harmonic_f0 = ADC_HARMONIC_F0_DEFAULT;
+
+// 设置基波频率(Hz)
+uint8_t adc_harmonic_set_fundamental(float f0)
+{
+    if (f0 < ADC_HARMONIC_F0_MIN || f0 > ADC_HARMONIC_F0_MAX)
+    {
+        return 0;
+    }
+
+    g_harmonic_f0 = f0;
+    return 1;
+}
+
+// 获取基波频率(Hz)
+float adc_harmonic_get_fundamental(void)
+{
+    return g_harmonic_f0;
+}
+
+// 对交织块中的一个通道计算基波及各次谐波幅值与THD，mean为该通道块均值（去直流）
+void adc_harmonic_block(const volatile uint16_t *block, uint32_t frames, uint8_t channels, uint8_t channel,
+                        float mean, float sample_rate, adc_harmonic_result_t *result)
+{
+    float coeff[ADC_HARMONIC_COUNT];
+    float s1[ADC_HARMONIC_COUNT] = {0};
+    float s2[ADC_HARMONIC_COUNT] = {0};
+    uint8_t count = 0;
+
+    memset(result, 0, sizeof(adc_harmonic_result_t));
+    if (frames < 2 || channel >= channels)
+    {
+        return;
+    }
+
+    for (uint8_t h = 0; h < ADC_HARMONIC_COUNT; h++)
+    {
+        float f = g_harmonic_f0 * (h + 1);
+        if (f >= sample_rate * 0.5f)
+            break;
+        coeff[h] = 2.0f * arm_cos_f32(2.0f * PI * f / sample_rate);
+        count++;
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Hann窗 w[i] = 0.5 - 0.5*cos(2*pi*i/frames)，(c, s)按单位圆旋转递推
+    float step = 2.0f * PI / frames;
+    float rot_c = arm_cos_f32(step);
+    float rot_s = arm_sin_f32(step);
+    float c = 1.0f;
+    float s = 0.0f;
+
+    block += channel;
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        float x = ((float)*block - mean) * (0.5f - 0.5f * c);
+        block += channels;
+
+        for (uint8_t h = 0; h < count; h++)
+        {
+            float s0 = x + coeff[h] * s1[h] - s2[h];
+            s2[h] = s1[h];
+            s1[h] = s0;
+        }
+
+        float cn = c * rot_c - s * rot_s;
+        s = s * rot_c + c * rot_s;
+        c = cn;
+    }
+
+    // |X|^2 = s1^2 + s2^2 - coeff*s1*s2；Hann相干增益0.5，峰值幅值 = 4|X|/N
+    float amp_gain = 4.0f / frames;
+    float harmonic_sq = 0.0f;
+
+    for (uint8_t h = 0; h < count; h++)
+    {
+        float power = s1[h] * s1[h] + s2[h] * s2[h] - coeff[h] * s1[h] * s2[h];
+        result->amp[h] = sqrtf((power > 0.0f) ? power : 0.0f) * amp_gain;
+        if (h > 0)
+            harmonic_sq += result->amp[h] * result->amp[h];
+    }
+
+    result->count = count;
+    result->thd = (result->amp[0] > 0.0f) ? 100.0f * sqrtf(harmonic_sq) / result->amp[0] : 0.0f;
+}
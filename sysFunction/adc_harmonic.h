@@ -0,0 +1,24 @@
+#ifndef __ADC_HARMONIC_H__
+#define __ADC_HARMONIC_H__
+
+#include "stdint.h"
+#include "adc_channel.h"
+
+#define ADC_HARMONIC_COUNT 8          // 基波+2..8次谐波
+#define ADC_HARMONIC_F0_DEFAULT 50.0f 
+#define ADC_HARMONIC_F0_MIN 40.0f     
+#define ADC_HARMONIC_F0_MAX 70.0f     
+
+typedef struct
+{
+    float amp[ADC_HARMONIC_COUNT]; // 各次谐波幅值（峰值，ADC码值），amp[0]为基波
+    float thd;                     // 总谐波畸变率(%)
+    uint8_t count;                 // 低于奈奎斯特频率的有效谐波数
+} adc_harmonic_result_t;
+
+uint8_t adc_harmonic_set_fundamental(float f0);                                                          
+float adc_harmonic_get_fundamental(void);                                                                
+void adc_harmonic_block(const volatile uint16_t *block, uint32_t frames, uint8_t channels, uint8_t channel,
+                        float mean, float sample_rate, adc_harmonic_result_t *result);                   
+
+#endif
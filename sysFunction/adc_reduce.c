@@ -0,0 +1,170 @@
+#include "adc_reduce.h"
+#include "main.h"
+#include "arm_math.h"
+#include "string.h"
+
+// 通道统计量清零
+static void adc_stats_reset(adc_channel_stats_t *stats, uint32_t count)
+{
+    stats->sum = 0;
+    stats->sum_sq = 0;
+    stats->min = 0xFFFF;
+    stats->max = 0;
+    stats->count = count;
+}
+
+// 多通道交织块归约（标量参考实现）
+// block按帧排列：每帧依次为ch0..ch(channels-1)各一个采样
+void adc_reduce_ref(const volatile uint16_t *block, uint32_t frames, uint8_t channels, adc_channel_stats_t *stats)
+{
+    for (uint8_t ch = 0; ch < channels; ch++)
+    {
+        adc_stats_reset(&stats[ch], frames);
+    }
+
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        for (uint8_t ch = 0; ch < channels; ch++)
+        {
+            uint16_t s = *block++;
+            adc_channel_stats_t *st = &stats[ch];
+
+            st->sum += s;
+            st->sum_sq += (uint32_t)s * s;
+            if (s < st->min)
+                st->min = s;
+            if (s > st->max)
+                st->max = s;
+        }
+    }
+}
+
+#if defined(ARM_MATH_DSP)
+
+// 累加结果合并到通道统计量
+static void adc_stats_fold(adc_channel_stats_t *stats, uint32_t sum, uint64_t sum_sq, uint16_t min, uint16_t max)
+{
+    stats->sum += sum;
+    stats->sum_sq += sum_sq;
+    if (min < stats->min)
+        stats->min = min;
+    if (max > stats->max)
+        stats->max = max;
+}
+
+// 多通道交织块归约（Cortex-M4 SIMD实现）
+// 偶数通道数时每帧恰好是channels/2个字，每个字是一对相邻通道[ch(2k+1):ch(2k)]；
+// 最小/最大值按半字lane并行求取，相邻两帧的同一列字经PKHBT/PKHTB重排为
+// 同通道两个采样后，SMLAD/SMLALD一次累加两个采样。block需4字节对齐。
+void adc_reduce(const volatile uint16_t *block, uint32_t frames, uint8_t channels, adc_channel_stats_t *stats)
+{
+    const uint32_t ones = 0x00010001;
+    uint32_t cols = channels >> 1;
+    uint32_t sum_lo[ADC_REDUCE_MAX_COLS], sum_hi[ADC_REDUCE_MAX_COLS];
+    uint64_t sq_lo[ADC_REDUCE_MAX_COLS], sq_hi[ADC_REDUCE_MAX_COLS];
+    uint32_t min2[ADC_REDUCE_MAX_COLS], max2[ADC_REDUCE_MAX_COLS];
+
+    // 奇数通道数时帧不按字对齐，退回标量实现
+    if ((channels & 1) || cols > ADC_REDUCE_MAX_COLS)
+    {
+        adc_reduce_ref(block, frames, channels, stats);
+        return;
+    }
+
+    for (uint32_t c = 0; c < cols; c++)
+    {
+        sum_lo[c] = sum_hi[c] = 0;
+        sq_lo[c] = sq_hi[c] = 0;
+        min2[c] = 0xFFFFFFFF;
+        max2[c] = 0;
+    }
+
+    const volatile uint32_t *words = (const volatile uint32_t *)block;
+    uint32_t pairs = frames >> 1;
+
+    while (pairs--)
+    {
+        for (uint32_t c = 0; c < cols; c++)
+        {
+            uint32_t w0 = words[c];
+            uint32_t w1 = words[c + cols];
+
+            __USUB16(w0, min2[c]);
+            min2[c] = __SEL(min2[c], w0);
+            __USUB16(w0, max2[c]);
+            max2[c] = __SEL(w0, max2[c]);
+            __USUB16(w1, min2[c]);
+            min2[c] = __SEL(min2[c], w1);
+            __USUB16(w1, max2[c]);
+            max2[c] = __SEL(w1, max2[c]);
+
+            uint32_t a = __PKHBT(w0, w1, 16);
+            uint32_t b = __PKHTB(w1, w0, 16);
+
+            sum_lo[c] = __SMLAD(a, ones, sum_lo[c]);
+            sq_lo[c] = __SMLALD(a, a, sq_lo[c]);
+            sum_hi[c] = __SMLAD(b, ones, sum_hi[c]);
+            sq_hi[c] = __SMLALD(b, b, sq_hi[c]);
+        }
+        words += cols * 2;
+    }
+
+    for (uint32_t c = 0; c < cols; c++)
+    {
+        adc_stats_reset(&stats[c * 2], frames);
+        adc_stats_reset(&stats[c * 2 + 1], frames);
+        adc_stats_fold(&stats[c * 2], sum_lo[c], sq_lo[c], min2[c] & 0xFFFF, max2[c] & 0xFFFF);
+        adc_stats_fold(&stats[c * 2 + 1], sum_hi[c], sq_hi[c], min2[c] >> 16, max2[c] >> 16);
+    }
+
+    // 奇数帧时处理最后一帧
+    if (frames & 1)
+    {
+        adc_channel_stats_t tail[ADC_REDUCE_MAX_COLS * 2];
+        adc_reduce_ref((const volatile uint16_t *)words, 1, channels, tail);
+        for (uint8_t ch = 0; ch < channels; ch++)
+        {
+            adc_stats_fold(&stats[ch], tail[ch].sum, tail[ch].sum_sq, tail[ch].min, tail[ch].max);
+        }
+    }
+}
+
+#else
+
+// 无DSP扩展时退回标量实现
+void adc_reduce(const volatile uint16_t *block, uint32_t frames, uint8_t channels, adc_channel_stats_t *stats)
+{
+    adc_reduce_ref(block, frames, channels, stats);
+}
+
+#endif
+
+// 由归约统计量导出波形参数，scale为码值到物理量的系数
+// rms为含直流的真有效值；std_dev为交流有效值；峰值因数按偏离均值的峰值/交流有效值计算
+void adc_wave_from_stats(const adc_channel_stats_t *stats, float scale, adc_wave_stats_t *wave)
+{
+    uint64_t n = stats->count;
+
+    if (n == 0)
+    {
+        memset(wave, 0, sizeof(adc_wave_stats_t));
+        return;
+    }
+
+    // 方差用整数求 n*sum_sq - sum^2，避免float大数相消
+    uint64_t sum = stats->sum;
+    uint64_t var_n2 = n * stats->sum_sq - sum * sum;
+    float mean = (float)stats->sum / (float)n;
+    float std_dev = sqrtf((float)var_n2) / (float)n;
+    float peak_up = (float)stats->max - mean;
+    float peak_down = mean - (float)stats->min;
+    float peak = (peak_up > peak_down) ? peak_up : peak_down;
+
+    wave->mean = mean * scale;
+    wave->rms = sqrtf((float)stats->sum_sq / (float)n) * scale;
+    wave->std_dev = std_dev * scale;
+    wave->min = stats->min * scale;
+    wave->max = stats->max * scale;
+    wave->peak_to_peak = (stats->max - stats->min) * scale;
+    wave->crest_factor = (std_dev > 0.0f) ? peak / std_dev : 0.0f;
+}
@@ -0,0 +1,33 @@
+#ifndef __ADC_REDUCE_H__
+#define __ADC_REDUCE_H__
+
+#include "stdint.h"
+#include "adc_channel.h"
+
+#define ADC_REDUCE_MAX_COLS (ADC_CHANNEL_MAX / 2)
+
+typedef struct
+{
+    uint32_t sum;    
+    uint64_t sum_sq; 
+    uint16_t min;    
+    uint16_t max;    
+    uint32_t count;  
+} adc_channel_stats_t;
+
+typedef struct
+{
+    float mean;         
+    float rms;          
+    float std_dev;      
+    float min;          
+    float max;          
+    float peak_to_peak; 
+    float crest_factor; 
+} adc_wave_stats_t;
+
+void adc_reduce_ref(const volatile uint16_t *block, uint32_t frames, uint8_t channels, adc_channel_stats_t *stats); 
+void adc_reduce(const volatile uint16_t *block, uint32_t frames, uint8_t channels, adc_channel_stats_t *stats);     
+void adc_wave_from_stats(const adc_channel_stats_t *stats, float scale, adc_wave_stats_t *wave);                      
+
+#endif
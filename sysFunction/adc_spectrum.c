@@ -0,0 +1,129 @@
+#include "adc_spectrum.h"
+#include "arm_math.h"
+#include "string.h"
+
+// 基于CMSIS-DSP arm_rfft_fast_f32的单通道频谱分析。
+// 工作区由调用者提供（复用采集缓冲），work_in与work_out各需fft_len个float且互不重叠，
+// 且不能与block重叠：block先被转换进work_in，FFT结果写入work_out。
+
+// 选取FFT点数：不超过帧数与工作区容量的最大2的幂
+uint16_t adc_spectrum_fft_len(uint32_t frames, uint32_t work_floats)
+{
+    uint32_t limit = (frames < work_floats) ? frames : work_floats;
+    uint32_t len = ADC_SPECTRUM_MAX_LEN;
+
+    while (len > limit)
+    {
+        len >>= 1;
+    }
+
+    return (len >= ADC_SPECTRUM_MIN_LEN) ? (uint16_t)len : 0;
+}
+
+// 取出指定通道，去直流并加Hann窗，返回直流分量（码值）
+static float adc_spectrum_load(const volatile uint16_t *block, uint8_t channels, uint8_t channel,
+                               uint16_t fft_len, float *work_in)
+{
+    uint32_t sum = 0;
+
+    for (uint16_t i = 0; i < fft_len; i++)
+    {
+        uint16_t s = block[(uint32_t)i * channels + channel];
+        work_in[i] = (float)s;
+        sum += s;
+    }
+
+    float mean = (float)sum / fft_len;
+    float step = 2.0f * PI / fft_len;
+
+    for (uint16_t i = 0; i < fft_len; i++)
+    {
+        float w = 0.5f - 0.5f * arm_cos_f32(step * i);
+        work_in[i] = (work_in[i] - mean) * w;
+    }
+
+    return mean;
+}
+
+// 按幅值插入主频表（降序）
+static void adc_spectrum_insert_peak(adc_spectrum_result_t *result, float freq, float amp)
+{
+    for (uint8_t i = 0; i < ADC_SPECTRUM_PEAKS; i++)
+    {
+        if (amp > result->peak_amp[i])
+        {
+            for (uint8_t j = ADC_SPECTRUM_PEAKS - 1; j > i; j--)
+            {
+                result->peak_freq[j] = result->peak_freq[j - 1];
+                result->peak_amp[j] = result->peak_amp[j - 1];
+            }
+            result->peak_freq[i] = freq;
+            result->peak_amp[i] = amp;
+            return;
+        }
+    }
+}
+
+// 对交织块中的一个通道做加窗实数FFT，输出主频与频带能量，scale为码值到物理量的系数
+uint8_t adc_spectrum_run(const volatile uint16_t *block, uint8_t channels, uint8_t channel, uint16_t fft_len,
+                         float *work_in, float *work_out, float sample_rate, float scale,
+                         adc_spectrum_result_t *result)
+{
+    arm_rfft_fast_instance_f32 fft;
+    uint16_t bins = fft_len / 2;
+
+    if (channel >= channels || arm_rfft_fast_init_f32(&fft, fft_len) != ARM_MATH_SUCCESS)
+    {
+        return 0;
+    }
+
+    memset(result, 0, sizeof(adc_spectrum_result_t));
+    result->fft_len = fft_len;
+    result->bin_hz = sample_rate / fft_len;
+    result->dc = adc_spectrum_load(block, channels, channel, fft_len, work_in) * scale;
+
+    arm_rfft_fast_f32(&fft, work_in, work_out, 0);
+
+    // 输出格式：[0]=直流实部 [1]=奈奎斯特实部，之后为复数对；幅值写回work_in（输入已被FFT破坏）
+    float *mag = work_in;
+    mag[0] = 0.0f;
+    arm_cmplx_mag_f32(&work_out[2], &mag[1], bins - 1);
+
+    // Hann窗相干增益0.5：单边谱峰值幅值 = 2*|X|/(N*0.5)
+    float amp_gain = 4.0f * scale / fft_len;
+    float energy_total = 0.0f;
+    float band_width = (float)bins / ADC_SPECTRUM_BANDS;
+
+    for (uint16_t k = 1; k < bins; k++)
+    {
+        float e = mag[k] * mag[k];
+        energy_total += e;
+        result->band_energy[(uint16_t)(k / band_width)] += e;
+
+        if (mag[k] > mag[k - 1] && (k + 1 >= bins || mag[k] >= mag[k + 1]))
+        {
+            // 抛物线插值修正峰值所在的分数频点
+            float offset = 0.0f;
+            if (k + 1 < bins)
+            {
+                float denom = mag[k - 1] - 2.0f * mag[k] + mag[k + 1];
+                if (denom != 0.0f)
+                    offset = 0.5f * (mag[k - 1] - mag[k + 1]) / denom;
+            }
+            adc_spectrum_insert_peak(result, (k + offset) * result->bin_hz, mag[k] * amp_gain);
+        }
+    }
+
+    if (energy_total > 0.0f)
+    {
+        for (uint8_t b = 0; b < ADC_SPECTRUM_BANDS; b++)
+        {
+            result->band_energy[b] = 100.0f * result->band_energy[b] / energy_total;
+        }
+    }
+
+    // Parseval：sum|X|^2 = N/2 * sum(x^2)，Hann窗能量增益3/8
+    result->total_rms = sqrtf(energy_total * 2.0f / ((float)fft_len * fft_len * 0.375f)) * scale;
+
+    return 1;
+}
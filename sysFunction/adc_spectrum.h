@@ -0,0 +1,27 @@
+#ifndef __ADC_SPECTRUM_H__
+#define __ADC_SPECTRUM_H__
+
+#include "stdint.h"
+
+#define ADC_SPECTRUM_MIN_LEN 32   // arm_rfft_fast_f32支持32..4096点
+#define ADC_SPECTRUM_MAX_LEN 4096
+#define ADC_SPECTRUM_PEAKS 3      
+#define ADC_SPECTRUM_BANDS 8      
+
+typedef struct
+{
+    uint16_t fft_len;                          
+    float bin_hz;                              // 频率分辨率(Hz)
+    float dc;                                  // 直流分量
+    float peak_freq[ADC_SPECTRUM_PEAKS];       // 主频(Hz)，按幅值降序
+    float peak_amp[ADC_SPECTRUM_PEAKS];        // 主频幅值（峰值）
+    float band_energy[ADC_SPECTRUM_BANDS];     // 0..fs/2等分频带能量占比(%)
+    float total_rms;                           // 交流分量有效值
+} adc_spectrum_result_t;
+
+uint16_t adc_spectrum_fft_len(uint32_t frames, uint32_t work_floats);                                     
+uint8_t adc_spectrum_run(const volatile uint16_t *block, uint8_t channels, uint8_t channel, uint16_t fft_len,
+                         float *work_in, float *work_out, float sample_rate, float scale,
+                         adc_spectrum_result_t *result);                                                   
+
+#endif
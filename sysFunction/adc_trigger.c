@@ -0,0 +1,302 @@
+#include "adc_trigger.h"
+#include "main.h"
+#include "string.h"
+
+// 示波器式预触发记录：ARMED状态下每个数据块拷入环形历史，
+// 某通道块内最大值达到门限即触发，保留触发前pre块与触发后post块，冻结后交由存储层写出。
+// 冻结期间不再记录历史，写出后历史清空重新计数，保证记录在时间上连续。
+// adc_trigger_push在块事件中断(RTOS模式为采集线程)中运行，ARMED->POST->FROZEN由push完成；
+// 主循环/线程侧的布防、撤销与使能切换会与push并发，在adc_event_lock下进行。
+// 存储任务读取冻结记录无需加锁：FROZEN状态下push不改动环形缓冲与记录参数，只有存储任务自己会离开FROZEN。
+
+// 4字节对齐：未记录突发时借作频谱分析的float工作区
+static __ALIGNED(4) uint16_t g_trigger_ring[ADC_TRIGGER_RING_BLOCKS][ADC_BLOCK_SAMPLES];
+static uint16_t g_trigger_levels[ADC_CHANNEL_COUNT];
+static adc_trigger_state_t g_trigger_state = ADC_TRIGGER_DISARMED;
+static uint8_t g_trigger_enabled = 1;
+static uint32_t g_trigger_pre_ms = ADC_TRIGGER_PRE_MS_DEFAULT;
+static uint32_t g_trigger_post_ms = ADC_TRIGGER_POST_MS_DEFAULT;
+
+static uint8_t g_ring_head = 0;     // 下一个写入位置
+static uint8_t g_ring_filled = 0;   // 有效历史块数
+static uint8_t g_burst_start = 0;   // 突发记录起始块
+static uint8_t g_burst_blocks = 0;  
+static uint8_t g_burst_pre = 0;     
+static uint8_t g_post_remaining = 0;
+static uint32_t g_burst_rate = 0;
+static uint32_t g_trigger_frame = 0;
+static uint8_t g_trigger_channel = 0;
+static uint32_t g_trigger_tick = 0;
+static uint32_t g_trigger_count = 0;
+static uint32_t g_trigger_missed = 0;
+static uint8_t g_ring_lent = 0; // 环形缓冲已借出作工作区，push不记录历史
+
+// 使能/禁止触发记录，禁止时撤销触发
+void adc_trigger_enable(uint8_t enable)
+{
+    adc_event_lock();
+    g_trigger_enabled = enable ? 1 : 0;
+    if (!g_trigger_enabled)
+    {
+        g_trigger_state = ADC_TRIGGER_DISARMED;
+        g_ring_filled = 0;
+    }
+    adc_event_unlock();
+}
+
+// 查询触发记录是否使能
+uint8_t adc_trigger_is_enabled(void)
+{
+    return g_trigger_enabled;
+}
+
+// 更新各通道触发门限（ADC码值），未使能或已冻结时只更新门限
+void adc_trigger_arm(const uint16_t *levels)
+{
+    adc_event_lock();
+    memcpy(g_trigger_levels, levels, sizeof(g_trigger_levels));
+
+    if (g_trigger_enabled && g_trigger_state == ADC_TRIGGER_DISARMED)
+    {
+        g_ring_filled = 0;
+        g_trigger_state = ADC_TRIGGER_ARMED;
+    }
+    adc_event_unlock();
+}
+
+// 撤销触发，丢弃未写出的记录
+void adc_trigger_disarm(void)
+{
+    adc_event_lock();
+    g_trigger_state = ADC_TRIGGER_DISARMED;
+    g_ring_filled = 0;
+    adc_event_unlock();
+}
+
+// 撤销未冻结的触发；已冻结的记录保留，由存储任务写完后撤销。
+// 判断与撤销在同一临界区内，避免判断后push恰好冻结记录而被丢弃
+void adc_trigger_cancel(void)
+{
+    adc_event_lock();
+    if (g_trigger_state != ADC_TRIGGER_FROZEN)
+    {
+        g_trigger_state = ADC_TRIGGER_DISARMED;
+        g_ring_filled = 0;
+    }
+    adc_event_unlock();
+}
+
+// 设置触发前后记录时长(ms)，两者之和超出环形缓冲容量时在触发时按块数截断
+uint8_t adc_trigger_set_window(uint32_t pre_ms, uint32_t post_ms)
+{
+    if (pre_ms > 60000 || post_ms > 60000)
+    {
+        return 0;
+    }
+
+    g_trigger_pre_ms = pre_ms;
+    g_trigger_post_ms = post_ms;
+    return 1;
+}
+
+// 获取触发前后记录时长(ms)
+void adc_trigger_get_window(uint32_t *pre_ms, uint32_t *post_ms)
+{
+    *pre_ms = g_trigger_pre_ms;
+    *post_ms = g_trigger_post_ms;
+}
+
+// 时长换算为块数（向上取整）
+static uint32_t adc_trigger_ms_to_blocks(uint32_t ms, uint32_t sample_rate)
+{
+    uint64_t frames = (uint64_t)ms * sample_rate;
+    uint64_t per_block = (uint64_t)ADC_BLOCK_FRAMES * 1000;
+
+    return (uint32_t)((frames + per_block - 1) / per_block);
+}
+
+// 在块内查找指定通道首个达到门限的帧
+static uint32_t adc_trigger_find_frame(const uint16_t *block, uint8_t channel, uint16_t level)
+{
+    for (uint32_t i = 0; i < ADC_BLOCK_FRAMES; i++)
+    {
+        if (block[i * ADC_CHANNEL_COUNT + channel] >= level)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// 触发：按当前采样率确定前后块数，记录触发位置
+static void adc_trigger_fire(uint8_t channel, uint32_t sample_rate)
+{
+    uint32_t pre = adc_trigger_ms_to_blocks(g_trigger_pre_ms, sample_rate);
+    uint32_t post = adc_trigger_ms_to_blocks(g_trigger_post_ms, sample_rate);
+
+    if (pre > g_ring_filled - 1)
+        pre = g_ring_filled - 1;
+    if (post > ADC_TRIGGER_RING_BLOCKS - 1 - pre)
+        post = ADC_TRIGGER_RING_BLOCKS - 1 - pre;
+
+    g_burst_pre = pre;
+    g_burst_blocks = pre + 1 + post;
+    g_burst_start = (g_ring_head + ADC_TRIGGER_RING_BLOCKS - pre) % ADC_TRIGGER_RING_BLOCKS;
+    g_post_remaining = post;
+    g_burst_rate = sample_rate;
+    g_trigger_channel = channel;
+    g_trigger_frame = pre * ADC_BLOCK_FRAMES +
+                      adc_trigger_find_frame(g_trigger_ring[g_ring_head], channel, g_trigger_levels[channel]);
+    g_trigger_tick = HAL_GetTick();
+    g_trigger_count++;
+
+    g_trigger_state = (post > 0) ? ADC_TRIGGER_POST : ADC_TRIGGER_FROZEN;
+}
+
+// 送入一个数据块及其归约统计量
+void adc_trigger_push(const volatile uint16_t *block, const adc_channel_stats_t *stats, uint32_t sample_rate)
+{
+    if (g_trigger_state == ADC_TRIGGER_DISARMED)
+    {
+        return;
+    }
+    if (g_trigger_state == ADC_TRIGGER_FROZEN || g_ring_lent)
+    {
+        for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+        {
+            if (stats[ch].max >= g_trigger_levels[ch])
+            {
+                g_trigger_missed++;
+                break;
+            }
+        }
+        return;
+    }
+
+    uint16_t *slot = g_trigger_ring[g_ring_head];
+    for (uint32_t i = 0; i < ADC_BLOCK_SAMPLES; i++)
+    {
+        slot[i] = block[i];
+    }
+    if (g_ring_filled < ADC_TRIGGER_RING_BLOCKS)
+    {
+        g_ring_filled++;
+    }
+
+    if (g_trigger_state == ADC_TRIGGER_ARMED)
+    {
+        for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+        {
+            if (stats[ch].max >= g_trigger_levels[ch])
+            {
+                adc_trigger_fire(ch, sample_rate);
+                break;
+            }
+        }
+    }
+    else if (g_trigger_state == ADC_TRIGGER_POST)
+    {
+        if (--g_post_remaining == 0)
+        {
+            g_trigger_state = ADC_TRIGGER_FROZEN;
+        }
+    }
+
+    g_ring_head = (g_ring_head + 1) % ADC_TRIGGER_RING_BLOCKS;
+}
+
+// 借出环形缓冲作临时工作区(至少bytes字节)，突发记录进行中(POST/FROZEN)或已借出返回NULL。
+// ARMED时预触发历史作废，借出期间越限只计入missed，归还后重新积累历史
+void *adc_trigger_borrow_ring(uint32_t bytes)
+{
+    void *area = NULL;
+
+    if (bytes > sizeof(g_trigger_ring))
+    {
+        return NULL;
+    }
+
+    adc_event_lock();
+    if (!g_ring_lent && (g_trigger_state == ADC_TRIGGER_DISARMED || g_trigger_state == ADC_TRIGGER_ARMED))
+    {
+        g_ring_lent = 1;
+        g_ring_filled = 0;
+        area = g_trigger_ring;
+    }
+    adc_event_unlock();
+    return area;
+}
+
+// 归还借出的环形缓冲，内容已被改写，历史从头积累
+void adc_trigger_return_ring(void)
+{
+    adc_event_lock();
+    g_ring_lent = 0;
+    g_ring_filled = 0;
+    adc_event_unlock();
+}
+
+// 获取触发状态
+adc_trigger_state_t adc_trigger_get_state(void)
+{
+    return g_trigger_state;
+}
+
+// 填写冻结记录的文件头（时间戳由调用者换算），返回块数，未冻结返回0
+uint16_t adc_trigger_get_burst(adc_burst_header_t *header, uint32_t *trigger_tick)
+{
+    if (g_trigger_state != ADC_TRIGGER_FROZEN)
+    {
+        return 0;
+    }
+
+    memset(header, 0, sizeof(adc_burst_header_t));
+    header->magic = ADC_BURST_MAGIC;
+    header->version = ADC_BURST_VERSION;
+    header->header_size = sizeof(adc_burst_header_t);
+    header->sample_rate = g_burst_rate;
+    header->channels = ADC_CHANNEL_COUNT;
+    header->frames_per_block = ADC_BLOCK_FRAMES;
+    header->blocks = g_burst_blocks;
+    header->pre_blocks = g_burst_pre;
+    header->trigger_frame = g_trigger_frame;
+    header->trigger_channel = g_trigger_channel;
+    header->trigger_level = g_trigger_levels[g_trigger_channel];
+    *trigger_tick = g_trigger_tick;
+
+    return g_burst_blocks;
+}
+
+// 按时间顺序获取冻结记录的第index块
+const uint16_t *adc_trigger_get_block(uint16_t index)
+{
+    if (index >= g_burst_blocks)
+    {
+        return NULL;
+    }
+    return g_trigger_ring[(g_burst_start + index) % ADC_TRIGGER_RING_BLOCKS];
+}
+
+// 记录已写出，清空历史重新布防
+void adc_trigger_release(void)
+{
+    adc_event_lock();
+    if (g_trigger_state == ADC_TRIGGER_FROZEN)
+    {
+        g_ring_filled = 0;
+        g_trigger_state = ADC_TRIGGER_ARMED;
+    }
+    adc_event_unlock();
+}
+
+// 累计触发次数
+uint32_t adc_trigger_get_count(void)
+{
+    return g_trigger_count;
+}
+
+// 冻结期间错过的越限块数
+uint32_t adc_trigger_get_missed(void)
+{
+    return g_trigger_missed;
+}
@@ -0,0 +1,58 @@
+#ifndef __ADC_TRIGGER_H__
+#define __ADC_TRIGGER_H__
+
+#include "stdint.h"
+#include "adc_channel.h"
+#include "adc_reduce.h"
+
+#define ADC_TRIGGER_RING_BLOCKS 8          // 预触发历史环形缓冲块数（每块ADC_BLOCK_SAMPLES个半字）
+#define ADC_TRIGGER_PRE_MS_DEFAULT 300     
+#define ADC_TRIGGER_POST_MS_DEFAULT 300    
+#define ADC_TRIGGER_LEVEL_OFF 0xFFFF       // 通道不参与触发
+#define ADC_BURST_MAGIC 0x42434441         // "ADCB"
+#define ADC_BURST_VERSION 1
+
+typedef enum
+{
+    ADC_TRIGGER_DISARMED = 0, 
+    ADC_TRIGGER_ARMED = 1,    // 记录历史，等待越限
+    ADC_TRIGGER_POST = 2,     // 已触发，采集触发后数据
+    ADC_TRIGGER_FROZEN = 3    // 突发记录已冻结，等待写出
+} adc_trigger_state_t;
+
+// 突发记录文件头，其后为blocks*frames_per_block帧交织的uint16原始采样（小端）
+typedef struct
+{
+    uint32_t magic;            
+    uint16_t version;          
+    uint16_t header_size;      
+    uint32_t timestamp;        // 触发时刻Unix时间
+    uint32_t sample_rate;      // 帧频率(Hz)
+    uint16_t channels;         
+    uint16_t frames_per_block; 
+    uint16_t blocks;           
+    uint16_t pre_blocks;       // 触发块之前的历史块数
+    uint32_t trigger_frame;    // 首个越限采样在记录中的帧序号
+    uint8_t trigger_channel;   
+    uint8_t reserved;          
+    uint16_t trigger_level;    // 触发门限（ADC码值）
+} adc_burst_header_t;
+
+void adc_trigger_enable(uint8_t enable);                                                                  
+uint8_t adc_trigger_is_enabled(void);                                                                     
+void adc_trigger_arm(const uint16_t *levels);                                                             
+void adc_trigger_disarm(void);
+void adc_trigger_cancel(void);                                                                            
+uint8_t adc_trigger_set_window(uint32_t pre_ms, uint32_t post_ms);                                        
+void adc_trigger_get_window(uint32_t *pre_ms, uint32_t *post_ms);                                         
+void adc_trigger_push(const volatile uint16_t *block, const adc_channel_stats_t *stats, uint32_t sample_rate); 
+void *adc_trigger_borrow_ring(uint32_t bytes);
+void adc_trigger_return_ring(void);
+adc_trigger_state_t adc_trigger_get_state(void);                                                          
+uint16_t adc_trigger_get_burst(adc_burst_header_t *header, uint32_t *trigger_tick);                       
+const uint16_t *adc_trigger_get_block(uint16_t index);                                                    
+void adc_trigger_release(void);                                                                           
+uint32_t adc_trigger_get_count(void);                                                                     
+uint32_t adc_trigger_get_missed(void);                                                                    
+
+#endif
@@ -0,0 +1,271 @@
+#include "app_threads.h"
+#include "periodic_timer.h"
+#include "string.h"
+#if APP_USE_RTOS
+#include "ff_gen_drv.h"
+#include "sd_diskio.h"
+#endif
+
+// 抢占式执行模式：采集、串口、采样、界面、SD卡分为五个按优先级抢占的线程。
+// 采集线程只与DMA中断和acq_lock打交道，不会被SD卡写入拖住；
+// 串口、采样、界面线程调用的模块不可重入，由app_lock串行化，记录只入存储队列；
+// SD卡线程在最低优先级写出存储队列，只持有fs_lock，卡的延迟不再传给其它线程。
+// 同一份代码在主机上与osal_posix.c一起编译，即可在Linux上运行与压测。
+
+#if APP_USE_RTOS || defined(OSAL_POSIX)
+
+#define APP_ACQ_QUEUE_LEN 1  // 仅作唤醒通知，数据块本身在adc_app的事件队列中
+#define APP_UART_QUEUE_LEN 4
+#define APP_UART_POLL_MS 5   // 串口线程无接收时的轮询周期，用于定时输出采样数据
+#define APP_SD_WAIT_MS 1     // SD卡DMA传输期间每次让出CPU的时长
+
+typedef struct
+{
+    void (*task_func)(void);
+    uint32_t rate_ms;
+    periodic_timer_t timer;
+} app_job_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t priority;
+    uint32_t stack_bytes;
+    uint32_t period_ms;  // 周期线程的节拍，0表示由队列驱动
+    app_job_t *jobs;
+    uint8_t job_count;
+    osal_mutex_t *lock;  // 周期线程运行任务时持有的锁
+} app_thread_t;
+
+static app_job_t sample_jobs[] =
+    {
+        {config_task, 5, {0}},
+        {sampling_task, 10, {0}}
+};
+
+static app_job_t ui_jobs[] =
+    {
+        {key_proc, 5, {0}},
+        {led_task, 10, {0}},
+        {oled_task, 100, {0}}
+};
+
+static app_job_t sd_jobs[] =
+    {
+        {data_storage_task, 5, {0}}
+};
+
+static osal_queue_t acq_queue;
+static osal_queue_t uart_queue;
+static osal_mutex_t acq_lock;  // 保护采集结果与采集状态
+static osal_mutex_t app_lock;  // 串行化串口、采样、界面线程对各功能模块的调用
+static osal_mutex_t fs_lock;   // 串行化FatFs访问(_FS_REENTRANT为0)
+static osal_thread_t app_lock_owner = NULL; // 持有app_lock的线程
+
+static app_thread_t app_threads[APP_THREAD_COUNT] =
+    {
+        {"acq", 0, 2048, 0, NULL, 0, NULL},
+        {"uart", 1, 2048, 0, NULL, 0, NULL},
+        {"sample", 2, 4096, 5, sample_jobs, sizeof(sample_jobs) / sizeof(app_job_t), &app_lock},
+        {"ui", 3, 1024, 5, ui_jobs, sizeof(ui_jobs) / sizeof(app_job_t), &app_lock},
+        {"sd", 4, 4096, 5, sd_jobs, sizeof(sd_jobs) / sizeof(app_job_t), &fs_lock}
+};
+static app_thread_stats_t app_thread_stats[APP_THREAD_COUNT];
+
+// 取得线程运行任务时持有的锁，app_lock另记下持有者
+static void app_thread_lock(osal_mutex_t *lock)
+{
+    osal_mutex_lock(*lock);
+    if (lock == &app_lock)
+        app_lock_owner = osal_thread_self();
+}
+
+static void app_thread_unlock(osal_mutex_t *lock)
+{
+    if (lock == &app_lock)
+        app_lock_owner = NULL;
+    osal_mutex_unlock(*lock);
+}
+
+// 采集线程：等待DMA半区就绪通知，处理事件队列中的全部数据块
+static void app_acq_thread(void *arg)
+{
+    uint8_t token;
+
+    (void)arg;
+    while (1)
+    {
+        osal_queue_recv(acq_queue, &token, OSAL_WAIT_FOREVER);
+        adc_event_drain();
+        app_thread_stats[APP_THREAD_ACQ].runs++;
+    }
+}
+
+// 串口线程：收到数据立即处理命令，否则按轮询周期处理定时输出
+static void app_uart_thread(void *arg)
+{
+    uint8_t token;
+    app_thread_stats_t *stats = &app_thread_stats[APP_THREAD_UART];
+
+    (void)arg;
+    while (1)
+    {
+        osal_queue_recv(uart_queue, &token, APP_UART_POLL_MS);
+
+        app_thread_lock(&app_lock);
+        uart_task();
+        app_thread_unlock(&app_lock);
+        stats->runs++;
+    }
+}
+
+// 周期线程：按节拍唤醒，依次运行到期的任务
+static void app_periodic_thread(void *arg)
+{
+    app_thread_t *thread = (app_thread_t *)arg;
+    app_thread_stats_t *stats = &app_thread_stats[thread - app_threads];
+    uint32_t wake = osal_now_ms();
+
+    for (uint8_t i = 0; i < thread->job_count; i++)
+    {
+        periodic_timer_start(&thread->jobs[i].timer, thread->jobs[i].rate_ms, PERIODIC_SKIP, wake);
+    }
+
+    while (1)
+    {
+        app_thread_lock(thread->lock);
+        uint32_t now = osal_now_ms();
+        uint32_t wait_ms = now - wake;
+
+        if (wait_ms > stats->max_wait_ms)
+            stats->max_wait_ms = wait_ms;
+
+        for (uint8_t i = 0; i < thread->job_count; i++)
+        {
+            if (periodic_timer_expired(&thread->jobs[i].timer, now))
+            {
+                thread->jobs[i].task_func();
+            }
+        }
+        app_thread_unlock(thread->lock);
+        stats->runs++;
+
+        // 一轮执行超出节拍时不补发，下一节拍从当前时刻重新对齐
+        if ((int32_t)(osal_now_ms() - (wake + thread->period_ms)) >= 0)
+        {
+            stats->overruns++;
+            wake = osal_now_ms() - thread->period_ms;
+        }
+        osal_delay_until(&wake, thread->period_ms);
+    }
+}
+
+// 创建队列、锁与各线程并启动调度，不返回
+#if APP_USE_RTOS
+// SD卡DMA传输期间由sd_diskio调用：阻塞当前线程，让出CPU而不是忙等
+static void app_sd_wait(void)
+{
+    uint32_t wake = osal_now_ms();
+
+    osal_delay_until(&wake, APP_SD_WAIT_MS);
+}
+#endif
+
+void app_threads_start(void)
+{
+    osal_thread_t handle;
+
+    if (osal_init() != OSAL_OK ||
+        osal_queue_create(&acq_queue, APP_ACQ_QUEUE_LEN, sizeof(uint8_t)) != OSAL_OK ||
+        osal_queue_create(&uart_queue, APP_UART_QUEUE_LEN, sizeof(uint8_t)) != OSAL_OK ||
+        osal_mutex_create(&acq_lock) != OSAL_OK ||
+        osal_mutex_create(&app_lock) != OSAL_OK ||
+        osal_mutex_create(&fs_lock) != OSAL_OK)
+    {
+        return;
+    }
+
+#if APP_USE_RTOS
+    sd_diskio_set_wait_hook(app_sd_wait);
+#endif
+
+    for (uint8_t i = 0; i < APP_THREAD_COUNT; i++)
+    {
+        app_thread_t *thread = &app_threads[i];
+        osal_entry_t entry = app_periodic_thread;
+
+        if (i == APP_THREAD_ACQ)
+            entry = app_acq_thread;
+        else if (i == APP_THREAD_UART)
+            entry = app_uart_thread;
+
+        if (osal_thread_create(&handle, thread->name, entry, thread, thread->stack_bytes, thread->priority) != OSAL_OK)
+        {
+            return;
+        }
+    }
+
+    osal_start();
+}
+
+// DMA中断中调用：唤醒采集线程，已有未处理的通知时直接忽略
+void app_notify_acq_from_isr(void)
+{
+    uint8_t token = 0;
+
+    osal_queue_send(acq_queue, &token, 0);
+}
+
+// 串口接收中断中调用：唤醒串口线程
+void app_notify_uart_from_isr(void)
+{
+    uint8_t token = 0;
+
+    osal_queue_send(uart_queue, &token, 0);
+}
+
+// 采集结果访问锁，替代裸机模式下的屏蔽事件中断
+void app_acq_lock(void)
+{
+    osal_mutex_lock(acq_lock);
+}
+
+void app_acq_unlock(void)
+{
+    osal_mutex_unlock(acq_lock);
+}
+
+// 存储任务之外直接访问FatFs(如读取config.ini)时持有
+void app_fs_lock(void)
+{
+    osal_mutex_lock(fs_lock);
+}
+
+void app_fs_unlock(void)
+{
+    osal_mutex_unlock(fs_lock);
+}
+
+// 当前线程是否持有app_lock(串口、采样、界面线程运行任务期间)
+uint8_t app_lock_held(void)
+{
+    return app_lock_owner != NULL && app_lock_owner == osal_thread_self();
+}
+
+// 获取线程运行统计并清零
+void app_threads_get_stats(app_thread_id_t id, app_thread_stats_t *stats)
+{
+    if (id >= APP_THREAD_COUNT || stats == NULL)
+        return;
+
+    *stats = app_thread_stats[id];
+    memset(&app_thread_stats[id], 0, sizeof(app_thread_stats_t));
+}
+
+// 获取线程名
+const char *app_threads_get_name(app_thread_id_t id)
+{
+    return id < APP_THREAD_COUNT ? app_threads[id].name : "";
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __APP_THREADS_H__
+#define __APP_THREADS_H__
+
+#include "stdint.h"
+#include "osal.h"
+
+// 执行模式：0为裸机主循环(scheduler_run)，1为抢占式RTOS线程
+#ifndef APP_USE_RTOS
+#define APP_USE_RTOS 0
+#endif
+
+// 线程中调用的任务入口，定义见各功能模块
+void adc_event_drain(void);
+void uart_task(void);
+void sampling_task(void);
+void data_storage_task(void);
+void config_task(void);
+void led_task(void);
+void key_proc(void);
+void oled_task(void);
+
+typedef struct
+{
+    uint32_t runs;
+    uint32_t max_wait_ms;  // 到期到开始执行(含等锁)的最大延迟
+    uint32_t overruns;     // 一轮执行超出线程周期的次数
+} app_thread_stats_t;
+
+typedef enum
+{
+    APP_THREAD_ACQ = 0,
+    APP_THREAD_UART = 1,
+    APP_THREAD_SAMPLE = 2,
+    APP_THREAD_UI = 3,
+    APP_THREAD_SD = 4,
+    APP_THREAD_COUNT = 5
+} app_thread_id_t;
+
+void app_threads_start(void);
+void app_notify_acq_from_isr(void);
+void app_notify_uart_from_isr(void);
+void app_acq_lock(void);
+void app_acq_unlock(void);
+void app_fs_lock(void);
+void app_fs_unlock(void);
+uint8_t app_lock_held(void);
+void app_threads_get_stats(app_thread_id_t id, app_thread_stats_t *stats);
+const char *app_threads_get_name(app_thread_id_t id);
+
+#endif
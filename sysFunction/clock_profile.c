@@ -0,0 +1,252 @@
+#include "clock_profile.h"
+#include "sdio.h"
+#include "spi.h"
+
+// 运行时切换系统时钟档位。PLL48CLK在各档位均保持48MHz，SDIO时钟源不变；
+// 切换时先把SYSCLK切到HSE，关PLL后修改调压档位与PLL参数，再切回PLL。
+// 切换完成后按新的总线频率重算TIM3、USART1、SPI2、SDIO、ADC与I2C1的分频。
+// 切换期间ADC触发暂停，抽取器复位。
+// 调用规则：裸机模式在主循环任务中调用；RTOS模式只能在持有app_lock的线程(串口、采样、界面)中调用，
+// 使串口、SPI Flash、OLED的使用者都已停下，否则返回CLOCK_PROFILE_DENIED；
+// SD卡由函数自己取fs_lock等待SD卡线程的传输结束(加锁顺序总是app_lock在前，fs_lock在后)。
+
+#define SPI_FLASH_MAX_HZ 21000000 // SPI2最高时钟
+#define ADC_CLOCK_MAX_HZ 30000000 // ADCCLK上限(VDD 2.4V以上取36MHz，留余量)
+#define UART_TC_TIMEOUT_MS 20
+#define ADC_LOAD_MAX_PERCENT 50 // 档位可用条件：数据块处理占用的CPU不超过该比例
+
+typedef struct
+{
+    const char *name;
+    uint32_t pllm;
+    uint32_t plln;
+    uint32_t pllq;
+    uint32_t voltage_scale;
+    uint32_t ahb_div;
+    uint32_t apb1_div;
+    uint32_t apb2_div;
+    uint32_t flash_latency;
+    uint32_t sdio_hz; // SDIO_CK目标频率，数据由DMA搬运，受限于HCLK下的DMA带宽
+} clock_profile_cfg_t;
+
+// HSE 25MHz
+static const clock_profile_cfg_t g_clock_profiles[CLOCK_PROFILE_COUNT] = {
+    {"low", 15, 144, 5, PWR_REGULATOR_VOLTAGE_SCALE3, RCC_SYSCLK_DIV8, RCC_HCLK_DIV1, RCC_HCLK_DIV1, FLASH_LATENCY_0, 3000000},
+    {"normal", 15, 144, 5, PWR_REGULATOR_VOLTAGE_SCALE3, RCC_SYSCLK_DIV1, RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_3, 24000000},
+    {"high", 25, 336, 7, PWR_REGULATOR_VOLTAGE_SCALE1, RCC_SYSCLK_DIV1, RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_5, 24000000}};
+
+static clock_profile_t g_clock_profile = CLOCK_PROFILE_NORMAL; // 与SystemClock_Config一致
+static uint8_t g_clock_auto = 1;
+static uint32_t g_clock_switches = 0;
+
+// 切换系统时钟：HSE过渡，重配PLL与调压档位，再切回PLL
+static clock_profile_status_t clock_profile_apply(const clock_profile_cfg_t *cfg)
+{
+    RCC_OscInitTypeDef osc = {0};
+    RCC_ClkInitTypeDef clk = {0};
+
+    clk.ClockType = RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSE;
+    clk.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    clk.APB1CLKDivider = RCC_HCLK_DIV1;
+    clk.APB2CLKDivider = RCC_HCLK_DIV1;
+    if (HAL_RCC_ClockConfig(&clk, __HAL_FLASH_GET_LATENCY()) != HAL_OK)
+    {
+        return CLOCK_PROFILE_ERROR;
+    }
+
+    // 调压档位只能在PLL关闭时修改
+    __HAL_RCC_PLL_DISABLE();
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY))
+    {
+    }
+    __HAL_PWR_VOLTAGESCALING_CONFIG(cfg->voltage_scale);
+
+    osc.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+    osc.PLL.PLLState = RCC_PLL_ON;
+    osc.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+    osc.PLL.PLLM = cfg->pllm;
+    osc.PLL.PLLN = cfg->plln;
+    osc.PLL.PLLP = RCC_PLLP_DIV2;
+    osc.PLL.PLLQ = cfg->pllq;
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+    {
+        return CLOCK_PROFILE_ERROR; // 停留在HSE 25MHz
+    }
+
+    uint32_t start = HAL_GetTick();
+    while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY))
+    {
+        if (HAL_GetTick() - start > 2)
+            return CLOCK_PROFILE_ERROR;
+    }
+
+    clk.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+    clk.AHBCLKDivider = cfg->ahb_div;
+    clk.APB1CLKDivider = cfg->apb1_div;
+    clk.APB2CLKDivider = cfg->apb2_div;
+    if (HAL_RCC_ClockConfig(&clk, cfg->flash_latency) != HAL_OK)
+    {
+        return CLOCK_PROFILE_ERROR;
+    }
+
+    return CLOCK_PROFILE_OK;
+}
+
+// 按当前总线频率重算各外设分频
+static void clock_profile_update_peripherals(const clock_profile_cfg_t *cfg)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    uint32_t pclk2 = HAL_RCC_GetPCLK2Freq();
+
+    // USART1(APB2)
+    huart1.Instance->BRR = UART_BRR_SAMPLING16(pclk2, huart1.Init.BaudRate);
+
+    // SPI2(APB1)：取不超过上限的最小分频
+    uint32_t br = 0;
+    while (br < 7 && (pclk1 >> (br + 1)) > SPI_FLASH_MAX_HZ)
+        br++;
+    __HAL_SPI_DISABLE(&hspi2);
+    hspi2.Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
+    MODIFY_REG(hspi2.Instance->CR1, SPI_CR1_BR, hspi2.Init.BaudRatePrescaler);
+
+    // SDIO：SDIO_CK = PLL48CLK / (CLKDIV + 2)，且不超过PCLK2的8/3
+    uint32_t pll48 = HSE_VALUE / cfg->pllm * cfg->plln / cfg->pllq;
+    uint32_t sdio_hz = cfg->sdio_hz;
+    if (sdio_hz > pclk2 / 3 * 8)
+        sdio_hz = pclk2 / 3 * 8;
+    uint32_t div = (pll48 + sdio_hz - 1) / sdio_hz;
+    div = div > 2 ? div - 2 : 0;
+    if (div > 0xFF)
+        div = 0xFF;
+    hsd.Init.ClockDiv = div;
+    MODIFY_REG(SDIO->CLKCR, SDIO_CLKCR_CLKDIV, div);
+
+    // ADC：PCLK2 / 2,4,6,8
+    uint32_t adcpre = 0;
+    while (adcpre < 3 && pclk2 / ((adcpre + 1) * 2) > ADC_CLOCK_MAX_HZ)
+        adcpre++;
+    hadc1.Init.ClockPrescaler = adcpre << ADC_CCR_ADCPRE_Pos;
+    MODIFY_REG(ADC123_COMMON->CCR, ADC_CCR_ADCPRE, hadc1.Init.ClockPrescaler);
+
+    // I2C1(APB1)：HAL按PCLK1重算CCR/TRISE
+    HAL_I2C_Init(&hi2c1);
+}
+
+// 切换时钟档位，按目标采样率重算TIM3分频，保持采样率不变
+clock_profile_status_t clock_profile_set(clock_profile_t profile)
+{
+    if (profile >= CLOCK_PROFILE_COUNT)
+        return CLOCK_PROFILE_INVALID;
+    if (profile == g_clock_profile)
+        return CLOCK_PROFILE_OK;
+#if APP_USE_RTOS
+    if (!app_lock_held())
+        return CLOCK_PROFILE_DENIED;
+#endif
+
+    const clock_profile_cfg_t *cfg = &g_clock_profiles[profile];
+    uint32_t rate = adc_get_requested_rate();
+
+    // 等待串口发送完成，避免改波特率时截断正在发送的字符
+    uint32_t start = HAL_GetTick();
+    while (!__HAL_UART_GET_FLAG(&huart1, UART_FLAG_TC) && HAL_GetTick() - start < UART_TC_TIMEOUT_MS)
+    {
+    }
+
+#if APP_USE_RTOS
+    // SDIO_CK取自PLL48CLK，关PLL前等SD卡线程结束当前的FatFs访问与DMA传输
+    app_fs_lock();
+#endif
+    HAL_TIM_Base_Stop(&htim3);
+    clock_profile_status_t status = clock_profile_apply(cfg);
+    if (status == CLOCK_PROFILE_OK)
+    {
+        g_clock_profile = profile;
+        g_clock_switches++;
+    }
+
+    // 失败时仍按实际运行的总线频率重算，保证串口等外设可用
+    clock_profile_update_peripherals(&g_clock_profiles[g_clock_profile]);
+#if APP_USE_RTOS
+    app_fs_unlock();
+#endif
+    adc_set_sample_rate(rate);
+
+    return status;
+}
+
+// 档位的HCLK频率
+static uint32_t clock_profile_hclk(const clock_profile_cfg_t *cfg)
+{
+    uint32_t sysclk = HSE_VALUE / cfg->pllm * cfg->plln / 2;
+    return sysclk >> AHBPrescTable[(cfg->ahb_div & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+}
+
+// 按实测的每块处理周期数估算档位能否承受该采样率，尚无实测值时返回0
+uint8_t clock_profile_fits_rate(clock_profile_t profile, uint32_t rate_hz)
+{
+    uint32_t block_cycles = adc_get_block_cycles();
+
+    if (profile >= CLOCK_PROFILE_COUNT || block_cycles == 0)
+        return 0;
+
+    uint64_t load = (uint64_t)block_cycles * rate_hz / ADC_BLOCK_FRAMES;
+    return load * 100 <= (uint64_t)clock_profile_hclk(&g_clock_profiles[profile]) * ADC_LOAD_MAX_PERCENT;
+}
+
+// 获取当前时钟档位
+clock_profile_t clock_profile_get(void)
+{
+    return g_clock_profile;
+}
+
+// 档位名称
+const char *clock_profile_name(clock_profile_t profile)
+{
+    return profile < CLOCK_PROFILE_COUNT ? g_clock_profiles[profile].name : "?";
+}
+
+// 按名称解析档位
+uint8_t clock_profile_parse(const char *name, clock_profile_t *profile)
+{
+    for (uint8_t i = 0; i < CLOCK_PROFILE_COUNT; i++)
+    {
+        if (strcmp(name, g_clock_profiles[i].name) == 0)
+        {
+            *profile = (clock_profile_t)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 开关自动选档：开启时由采样任务按工作状态选择档位
+void clock_profile_set_auto(uint8_t enable)
+{
+    g_clock_auto = enable ? 1 : 0;
+}
+
+uint8_t clock_profile_get_auto(void)
+{
+    return g_clock_auto;
+}
+
+// 打印当前档位与各总线/外设时钟
+void clock_profile_report(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    uint32_t pclk2 = HAL_RCC_GetPCLK2Freq();
+    const clock_profile_cfg_t *cfg = &g_clock_profiles[g_clock_profile];
+    uint32_t pll48 = HSE_VALUE / cfg->pllm * cfg->plln / cfg->pllq;
+    uint32_t adc_div = (((ADC123_COMMON->CCR & ADC_CCR_ADCPRE) >> ADC_CCR_ADCPRE_Pos) + 1) * 2;
+    uint32_t spi_div = 2u << ((hspi2.Instance->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos);
+
+    my_printf(&huart1, "clock profile: %s (%s), %lu switches\r\n",
+              clock_profile_name(g_clock_profile), g_clock_auto ? "auto" : "manual", g_clock_switches);
+    my_printf(&huart1, "SYSCLK %luMHz HCLK %luMHz PCLK1 %luMHz PCLK2 %luMHz\r\n",
+              HAL_RCC_GetSysClockFreq() / 1000000, HAL_RCC_GetHCLKFreq() / 1000000, pclk1 / 1000000, pclk2 / 1000000);
+    my_printf(&huart1, "ADC %lukHz SDIO %lukHz SPI2 %lukHz UART %lu baud TIM3 %luHz (target %luHz)\r\n",
+              pclk2 / adc_div / 1000, pll48 / (((SDIO->CLKCR & SDIO_CLKCR_CLKDIV)) + 2) / 1000, pclk1 / spi_div / 1000,
+              pclk2 / huart1.Instance->BRR, adc_get_sample_rate(), adc_get_requested_rate());
+}
@@ -0,0 +1,31 @@
+#ifndef __CLOCK_PROFILE_H__
+#define __CLOCK_PROFILE_H__
+
+#include "mydefine.h"
+
+typedef enum
+{
+    CLOCK_PROFILE_LOW = 0,    // 15MHz HCLK，低功耗记录
+    CLOCK_PROFILE_NORMAL = 1, // 120MHz，上电默认
+    CLOCK_PROFILE_HIGH = 2,   // 168MHz，FFT/突发记录
+    CLOCK_PROFILE_COUNT = 3
+} clock_profile_t;
+
+typedef enum
+{
+    CLOCK_PROFILE_OK = 0,
+    CLOCK_PROFILE_ERROR = 1,
+    CLOCK_PROFILE_INVALID = 2,
+    CLOCK_PROFILE_DENIED = 3 // RTOS模式下调用线程未持有app_lock
+} clock_profile_status_t;
+
+clock_profile_status_t clock_profile_set(clock_profile_t profile);
+clock_profile_t clock_profile_get(void);
+uint8_t clock_profile_fits_rate(clock_profile_t profile, uint32_t rate_hz);
+const char *clock_profile_name(clock_profile_t profile);
+uint8_t clock_profile_parse(const char *name, clock_profile_t *profile);
+void clock_profile_set_auto(uint8_t enable);
+uint8_t clock_profile_get_auto(void);
+void clock_profile_report(void);
+
+#endif
@@ -2,19 +2,50 @@
 #include "stddef.h"
 #include "string.h"
 #include "gd25qxx.h"
+#include "pt.h"
 
 // 配置参数全局变量
 static config_params_t g_config_params = {0};
 static uint8_t g_config_initialized = 0;
 
+// 异步保存：保存请求复制一份配置镜像，由config_task(5ms周期)中的协程擦除/编程FLASH，等待期间让出，
+// 写完后回读校验，结果经完成回调通知
+static config_params_t g_config_save_image;
+static uint8_t g_config_save_pending = 0;
+static uint8_t g_config_save_busy = 0;
+static pt_t g_config_save_pt = {0};
+static config_save_callback_t g_config_save_callback = NULL;
+
+#define CONFIG_DEFAULT_RATIO 1.0f
+#define CONFIG_DEFAULT_LIMIT 100.0f
+
 // 默认配置
-static const config_params_t default_config = {
-    .magic = CONFIG_MAGIC,
-    .version = CONFIG_VERSION,
-    .ratio = 1.0f,
-    .limit = 100.0f,
-    .cycle = CYCLE_5S,
-    .crc32 = 0};
+static void config_load_default(config_params_t *params)
+{
+    memset(params, 0, sizeof(config_params_t));
+    params->magic = CONFIG_MAGIC;
+    params->version = CONFIG_VERSION;
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        params->ratio[ch] = CONFIG_DEFAULT_RATIO;
+        params->limit[ch] = CONFIG_DEFAULT_LIMIT;
+    }
+    params->cycle = CYCLE_5S;
+    params->crc32 = 0;
+}
+
+// 校验全部通道的ratio/limit
+static config_status_t config_validate_channels(const config_params_t *params)
+{
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        if (config_validate_ratio(params->ratio[ch]) != CONFIG_OK)
+            return CONFIG_INVALID;
+        if (config_validate_limit(params->limit[ch]) != CONFIG_OK)
+            return CONFIG_INVALID;
+    }
+    return CONFIG_OK;
+}
 
 // CRC32查找表
 static const uint32_t crc32_table[16] = {
@@ -71,7 +102,7 @@ config_status_t config_init(void)
     config_status_t status = config_load_from_flash();
     if (status != CONFIG_OK)
     {
-        g_config_params = default_config;
+        config_load_default(&g_config_params);
         g_config_params.crc32 = config_calculate_crc32(&g_config_params);
     }
 
@@ -99,15 +130,13 @@ config_status_t config_set_params(const config_params_t *params)
     if (!g_config_initialized)
         return CONFIG_ERROR;
 
-    if (config_validate_ratio(params->ratio) != CONFIG_OK)
-        return CONFIG_INVALID;
-    if (config_validate_limit(params->limit) != CONFIG_OK)
+    if (config_validate_channels(params) != CONFIG_OK)
         return CONFIG_INVALID;
     if (config_validate_sampling_cycle(params->cycle) != CONFIG_OK)
         return CONFIG_INVALID;
 
-    g_config_params.ratio = params->ratio;
-    g_config_params.limit = params->limit;
+    memcpy(g_config_params.ratio, params->ratio, sizeof(g_config_params.ratio));
+    memcpy(g_config_params.limit, params->limit, sizeof(g_config_params.limit));
     g_config_params.cycle = params->cycle;
     g_config_params.crc32 = config_calculate_crc32(&g_config_params);
 
@@ -117,32 +146,93 @@ config_status_t config_set_params(const config_params_t *params)
 // 恢复默认配置
 config_status_t config_reset_to_default(void)
 {
-    g_config_params = default_config;
+    config_load_default(&g_config_params);
     g_config_params.crc32 = config_calculate_crc32(&g_config_params);
     g_config_initialized = 1;
     return CONFIG_OK;
 }
 
-// 保存配置到FLASH
+// 保存配置到FLASH（异步）：登记保存请求后返回CONFIG_PENDING，实际擦写由config_task完成，
+// 完成后调用完成回调；保存进行中再次请求时，本轮结束后按最新配置再写一次
 config_status_t config_save_to_flash(void)
 {
     if (!g_config_initialized)
         return CONFIG_ERROR;
 
     g_config_params.crc32 = config_calculate_crc32(&g_config_params);
+    g_config_save_pending = 1;
 
-    spi_flash_sector_erase(CONFIG_FLASH_ADDR);
+    return CONFIG_PENDING;
+}
 
-    spi_flash_buffer_write((uint8_t *)&g_config_params, CONFIG_FLASH_ADDR, sizeof(config_params_t));
+// 设置保存完成回调，在config_task中以CONFIG_OK或CONFIG_FLASH_ERROR调用
+void config_set_save_callback(config_save_callback_t callback)
+{
+    g_config_save_callback = callback;
+}
 
-    return CONFIG_OK;
+// 配置保存是否尚未完成
+uint8_t config_save_in_progress(void)
+{
+    return g_config_save_pending || g_config_save_busy;
 }
 
-// 从FLASH加载配置
+// 配置保存协程：擦除扇区后逐页编程，每次等待FLASH忙时让出
+static char config_save_thread(pt_t *pt)
+{
+    static uint32_t offset;
+    config_params_t verify;
+
+    PT_BEGIN(pt);
+
+    PT_WAIT_UNTIL(pt, g_config_save_pending);
+    g_config_save_pending = 0;
+    g_config_save_busy = 1;
+    g_config_save_image = g_config_params;
+
+    PT_WAIT_WHILE(pt, spi_flash_is_busy());
+    spi_flash_sector_erase_start(CONFIG_FLASH_ADDR);
+    PT_WAIT_WHILE(pt, spi_flash_is_busy());
+
+    for (offset = 0; offset < sizeof(config_params_t);)
+    {
+        uint32_t addr = CONFIG_FLASH_ADDR + offset;
+        uint32_t chunk = SPI_FLASH_PAGE_SIZE - (addr % SPI_FLASH_PAGE_SIZE);
+        if (chunk > sizeof(config_params_t) - offset)
+            chunk = sizeof(config_params_t) - offset;
+
+        spi_flash_page_write_start((uint8_t *)&g_config_save_image + offset, addr, chunk);
+        offset += chunk;
+        PT_WAIT_WHILE(pt, spi_flash_is_busy());
+    }
+
+    spi_flash_buffer_read((uint8_t *)&verify, CONFIG_FLASH_ADDR, sizeof(config_params_t));
+    g_config_save_busy = 0;
+    if (g_config_save_callback != NULL)
+    {
+        g_config_save_callback(memcmp(&verify, &g_config_save_image, sizeof(config_params_t)) == 0 ? CONFIG_OK
+                                                                                                 : CONFIG_FLASH_ERROR);
+    }
+
+    PT_END(pt);
+}
+
+// 配置任务：推进配置保存协程
+void config_task(void)
+{
+    config_save_thread(&g_config_save_pt);
+}
+
+// 从FLASH加载配置，保存未完成时返回CONFIG_PENDING(扇区可能正在擦写)，由调用方稍后重试
 config_status_t config_load_from_flash(void)
 {
     config_params_t temp_config;
 
+    if (config_save_in_progress())
+    {
+        return CONFIG_PENDING;
+    }
+
     spi_flash_buffer_read((uint8_t *)&temp_config, CONFIG_FLASH_ADDR, sizeof(config_params_t));
 
     if (temp_config.magic != CONFIG_MAGIC)
@@ -161,8 +251,7 @@ config_status_t config_load_from_flash(void)
         return CONFIG_CRC_ERROR;
     }
 
-    if (config_validate_ratio(temp_config.ratio) != CONFIG_OK ||
-        config_validate_limit(temp_config.limit) != CONFIG_OK ||
+    if (config_validate_channels(&temp_config) != CONFIG_OK ||
         config_validate_sampling_cycle(temp_config.cycle) != CONFIG_OK)
     {
         return CONFIG_INVALID;
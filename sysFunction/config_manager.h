@@ -3,17 +3,18 @@
 
 #include "stdint.h"
 #include "sampling_control.h" 
+#include "adc_channel.h"
 
 #define CONFIG_FLASH_ADDR 0x1F0000 
 #define CONFIG_MAGIC 0x43464721     
-#define CONFIG_VERSION 0x02        
+#define CONFIG_VERSION 0x03        
 
 typedef struct 
 {
     uint32_t magic;              
     uint8_t version;            
-    float ratio;                
-    float limit;                 
+    float ratio[ADC_CHANNEL_COUNT]; 
+    float limit[ADC_CHANNEL_COUNT]; 
     sampling_cycle_t cycle;      
     uint32_t crc32;             
 } config_params_t;
@@ -24,14 +25,20 @@ typedef enum
     CONFIG_ERROR = 1,        
     CONFIG_INVALID = 2,      
     CONFIG_FLASH_ERROR = 3, 
-    CONFIG_CRC_ERROR = 4     
+    CONFIG_CRC_ERROR = 4,
+    CONFIG_PENDING = 5 // 保存已登记或正在进行，结果经完成回调通知
 } config_status_t;
 
+typedef void (*config_save_callback_t)(config_status_t status);
+
 
 config_status_t config_init(void);                                     
 config_status_t config_get_params(config_params_t *params);             
 config_status_t config_set_params(const config_params_t *params);       
 config_status_t config_save_to_flash(void);                            
+uint8_t config_save_in_progress(void);                                  
+void config_set_save_callback(config_save_callback_t callback);         
+void config_task(void);                                                 
 config_status_t config_load_from_flash(void);                           
 config_status_t config_reset_to_default(void);                          
 config_status_t config_validate_ratio(float ratio);                    
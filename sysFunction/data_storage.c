@@ -4,10 +4,122 @@
 #include "usart_app.h"
 #include "string.h"
 #include "stdio.h"
+#include "sampling_control.h"
+#include "adc_trigger.h"
+#include "pt.h"
+#include "sample_bin.h"
+#include "diskio.h"
+#include "spsc_ring.h"
+
+// 采样记录行长度：时间戳 + 每通道电压列与波形参数列
+#define SAMPLE_LINE_SIZE (32 + ADC_CHANNEL_COUNT * 72)
+
+// 每个文件的记录条数
+#define STORAGE_FILE_RECORDS 10
+#define STORAGE_BIN_FILE_RECORDS 3600
+
+// 写回缓存：各流记录先缓存在RAM，按记录数/滞留时间/停止采样/掉电预警成组提交，减少FAT与目录项更新次数。
+// 缓存放不下和达到记录数/滞留时间的提交只写到SD扇区边界，不足一扇区的尾部留在缓存，
+// 避免反复改写同一扇区；换文件、显式提交与掉电预警才写出全部数据
+#define STORAGE_SECTOR_SIZE 512
+#define STORAGE_PVD_LEVEL PWR_PVDLEVEL_6 // 约2.8V
+#define STORAGE_PVD_IRQ_PRIORITY 1
+#define STORAGE_REMOUNT_MS 1000 // SD卡异常后重新挂载的间隔
+
+// 流式文件：新文件按一个轮换周期的大小用f_expand预分配连续簇，目录项大小即为整个连续区，
+// 写入期间不再分配簇、更新FAT，簇链映射表(快速定位)免去查FAT；只按整扇区写入，
+// 持久化点把未满的尾扇区补0写出后同步，关闭时截断到实际大小，释放多余的簇。
+// 掉电后文件保持预分配大小，数据之后是补0的扇区，读取时以首条校验失败的记录为末尾。
+// 无法分配连续空间时退回普通追加写
+#define STORAGE_CLMT_ITEMS 4 // 连续区只有一个片段：表长、片段簇数、起始簇、结束标记
+#define STORAGE_BIN_EXTENT (sizeof(sample_bin_header_t) + STORAGE_BIN_FILE_RECORDS * SAMPLE_BIN_RECORD_SIZE(ADC_CHANNEL_COUNT) + STORAGE_SECTOR_SIZE)
+
+// 记录队列：采样、按键与串口命令只格式化记录并入队，由存储任务成批写入缓存与SD卡，
+// 生产者不再等待SD卡；队列放不下时丢弃新记录并计数，占用超过高水位时置忙标志提示界面
+#define STORAGE_QUEUE_SIZE 4096                         // 2的幂
+#define STORAGE_QUEUE_HIGH (STORAGE_QUEUE_SIZE * 3 / 4) // 达到后置忙标志
+#define STORAGE_QUEUE_LOW (STORAGE_QUEUE_SIZE / 4)      // 回落到此以下清除忙标志
+#define STORAGE_DRAIN_RECORDS 32                        // 存储任务每次最多写入的记录数
+#define STORAGE_DRAIN_MS 3                              // 存储任务每次写入的时间预算
+#define STORAGE_DRAIN_ALL 0xFFFFFFFF                    // 不限条数与时间，写空队列
+// 每次存储任务最多进行一次缓存提交(f_write/f_sync)，达到记录数或滞留时间的提交也放到任务里逐个进行，
+// 单次提交本身不可拆分，其耗时取决于SD卡
+#define STORAGE_MSG_MAX (SAMPLE_LINE_SIZE > 256 ? SAMPLE_LINE_SIZE : 256)
+
+typedef enum
+{
+    STORAGE_COMMIT_CAPACITY = 0, // 缓存放不下：写到扇区边界，不同步
+    STORAGE_COMMIT_POLICY = 1,   // 达到记录数或滞留时间：写到扇区边界并同步
+    STORAGE_COMMIT_FORCED = 2    // 换文件、显式提交、掉电预警：全部写出并同步
+} storage_commit_mode_t;
+
+typedef struct
+{
+    uint8_t type;    // storage_type_t
+    uint8_t newline; // 写入时在记录后补换行
+    uint16_t length; // 其后记录内容的字节数
+} storage_msg_t;
+
+typedef struct
+{
+    uint8_t *buffer;
+    uint16_t capacity;
+    uint16_t length;
+    uint8_t records;     // 缓存中的记录数
+    uint32_t first_tick; // 最早一条缓存记录的写入时刻
+} storage_cache_t;
+
+typedef struct
+{
+    uint8_t active;                // 当前文件已预分配连续区
+    uint32_t extent;               // 预分配字节数，即目录项中的文件大小
+    uint32_t written;              // 已写出的整扇区字节数，缓存开头对应该文件偏移
+    uint32_t size;                 // 已写到卡上的数据字节数(含补0写出的尾部)，关闭时截断到此
+    DWORD clmt[STORAGE_CLMT_ITEMS]; // 簇链映射表
+} storage_stream_t;
+
+typedef struct
+{
+    uint32_t records;
+    uint32_t commits;
+    uint32_t bytes;
+    uint32_t errors;
+    uint32_t power_fails;
+    uint32_t remounts;
+    uint32_t extents;        // 成功预分配的文件数
+    uint32_t extent_fails;   // 无连续空间退回普通写的次数
+    uint32_t queued;         // 入队记录数，生产者侧计数
+    uint32_t dropped;        // 队列满或写入失败丢弃的记录数
+    uint32_t queue_peak;     // 队列占用字节数的高水位
+} storage_cache_stats_t;
 
 // 文件状态全局变量
 static file_state_t g_file_states[STORAGE_TYPE_COUNT];
+static __ALIGNED(4) uint8_t g_sample_cache[4 * STORAGE_SECTOR_SIZE];
+static __ALIGNED(4) uint8_t g_overlimit_cache[2 * STORAGE_SECTOR_SIZE];
+static __ALIGNED(4) uint8_t g_log_cache[2 * STORAGE_SECTOR_SIZE];
+static __ALIGNED(4) uint8_t g_hidedata_cache[2 * STORAGE_SECTOR_SIZE];
+static __ALIGNED(4) uint8_t g_binary_cache[4 * STORAGE_SECTOR_SIZE];
+static storage_cache_t g_caches[STORAGE_TYPE_COUNT] = {
+    {g_sample_cache, sizeof(g_sample_cache), 0, 0, 0},
+    {g_overlimit_cache, sizeof(g_overlimit_cache), 0, 0, 0},
+    {g_log_cache, sizeof(g_log_cache), 0, 0, 0},
+    {g_hidedata_cache, sizeof(g_hidedata_cache), 0, 0, 0},
+    {g_binary_cache, sizeof(g_binary_cache), 0, 0, 0}};
+static storage_stream_t g_streams[STORAGE_TYPE_COUNT];
+static __ALIGNED(4) uint8_t g_stream_sector[STORAGE_SECTOR_SIZE]; // 尾扇区补0写出用
+static storage_cache_policy_t g_cache_policy = {STORAGE_FILE_RECORDS, 30000, 1};
+static storage_cache_stats_t g_cache_stats = {0};
+static __IO uint8_t g_power_low = 0;
+static __IO uint8_t g_power_fail_pending = 0;
+static uint8_t g_sd_fault = 0; // SD卡访问出错，文件句柄已失效，等待重新挂载
+static uint32_t g_remount_tick = 0;
+static uint8_t g_binary_enabled = 0; // 采样数据写入bin/二进制记录流，不再写文本
 static uint32_t g_boot_count = 0;
+static spsc_ring_t g_queue;
+static uint8_t g_queue_pool[STORAGE_QUEUE_SIZE];
+static __IO uint8_t g_queue_busy = 0;    // 队列积压，写入跟不上记录产生速度
+static __IO uint8_t g_flush_request = 0; // 队列写空后提交全部缓存
 static data_storage_status_t create_default_config_ini(void);
 // 目录名和文件名前缀
 static const char *g_directory_names[STORAGE_TYPE_COUNT] = {
@@ -15,14 +127,26 @@ static const char *g_directory_names[STORAGE_TYPE_COUNT] = {
     "sample",
     "overLimit",
     "log",
-    "hideData"};
+    "hideData",
+    "bin"};
 
 static const char *g_filename_prefixes[STORAGE_TYPE_COUNT] = {
 
     "sampleData",
     "overLimit",
     "log",
-    "hideData"};
+    "hideData",
+    "sampleData"};
+
+// 流式写入的预分配大小，0为普通追加写
+static const uint32_t g_stream_extents[STORAGE_TYPE_COUNT] = {0, 0, 0, 0, STORAGE_BIN_EXTENT};
+
+static const uint16_t g_file_records[STORAGE_TYPE_COUNT] = {
+    STORAGE_FILE_RECORDS,
+    STORAGE_FILE_RECORDS,
+    STORAGE_FILE_RECORDS,
+    STORAGE_FILE_RECORDS,
+    STORAGE_BIN_FILE_RECORDS};
 
 // 获取启动次数
 static uint32_t get_boot_count_from_fatfs(void)
@@ -97,10 +221,11 @@ static data_storage_status_t create_storage_directories(void)
     return (success_count == STORAGE_TYPE_COUNT) ? DATA_STORAGE_OK : DATA_STORAGE_ERROR;
 }
 
-// 数据存储初始化
-data_storage_status_t data_storage_init(void)
+static void storage_power_monitor_init(void);
+
+// 挂载SD卡并创建目录，首次挂载成功时更新启动次数
+static data_storage_status_t storage_mount(void)
 {
-    memset(g_file_states, 0, sizeof(g_file_states));
     FRESULT mount_result = f_mount(&SDFatFS, SDPath, 1);
     if (mount_result != FR_OK)
     {
@@ -113,6 +238,11 @@ data_storage_status_t data_storage_init(void)
         my_printf(&huart1, "Warning: Some directories creation failed, system may not work properly\r\n");
     }
 
+    if (g_boot_count != 0)
+    {
+        return DATA_STORAGE_OK;
+    }
+
     g_boot_count = get_boot_count_from_fatfs();
     g_boot_count++;
 
@@ -127,7 +257,259 @@ data_storage_status_t data_storage_init(void)
     return DATA_STORAGE_OK;
 }
 
-// 检查并更新文件名
+// 数据存储初始化，未插卡时由存储任务定期重试挂载
+data_storage_status_t data_storage_init(void)
+{
+    memset(g_file_states, 0, sizeof(g_file_states));
+    memset(g_streams, 0, sizeof(g_streams));
+    spsc_ring_init(&g_queue, g_queue_pool, sizeof(g_queue_pool));
+    storage_power_monitor_init();
+
+    data_storage_status_t result = storage_mount();
+    g_sd_fault = (result != DATA_STORAGE_OK);
+    g_remount_tick = HAL_GetTick();
+
+    return result;
+}
+
+// SD卡被拔出或通信失败
+static uint8_t storage_media_error(FRESULT res)
+{
+    return res == FR_DISK_ERR || res == FR_INT_ERR || res == FR_NOT_READY ||
+           res == FR_INVALID_OBJECT || res == FR_NO_FILESYSTEM;
+}
+
+static FRESULT storage_stream_open(storage_type_t type);
+static FRESULT storage_stream_resume(storage_type_t type);
+
+// 打开流的当前文件并定位到末尾，已打开则直接复用；已预分配的流式文件定位到已写出的位置
+static FRESULT storage_file_open(storage_type_t type)
+{
+    file_state_t *state = &g_file_states[type];
+    if (state->file_open)
+    {
+        return FR_OK;
+    }
+
+    char full_path[96];
+    sprintf(full_path, "%s/%s", g_directory_names[type], state->current_filename);
+    FRESULT res = f_open(&state->file_handle, full_path, FA_OPEN_ALWAYS | FA_WRITE);
+    if (res != FR_OK)
+    {
+        return res;
+    }
+
+    storage_stream_t *stream = &g_streams[type];
+    FSIZE_t size = f_size(&state->file_handle);
+    if (stream->active && size == stream->extent)
+    {
+        res = storage_stream_resume(type);
+    }
+    else
+    {
+        stream->active = 0;
+        res = f_lseek(&state->file_handle, size);
+        if (res == FR_OK && g_stream_extents[type] != 0 && size == 0)
+        {
+            res = storage_stream_open(type);
+        }
+    }
+    if (res != FR_OK)
+    {
+        stream->active = 0;
+        f_close(&state->file_handle);
+        return res;
+    }
+
+    state->file_open = 1;
+    return FR_OK;
+}
+
+// 建立簇链映射表并定位到已写出的位置，之后按整扇区写入时不再查FAT
+static FRESULT storage_stream_resume(storage_type_t type)
+{
+    storage_stream_t *stream = &g_streams[type];
+    FIL *file = &g_file_states[type].file_handle;
+
+    stream->clmt[0] = STORAGE_CLMT_ITEMS;
+    file->cltbl = stream->clmt;
+    FRESULT res = f_lseek(file, CREATE_LINKMAP);
+    if (res == FR_OK)
+    {
+        res = f_lseek(file, stream->written);
+    }
+    if (res != FR_OK)
+    {
+        file->cltbl = 0;
+    }
+    return res;
+}
+
+// 空文件预分配连续区，目录项大小随之记为整个连续区并同步；无连续空间时退回普通追加写
+static FRESULT storage_stream_open(storage_type_t type)
+{
+    storage_stream_t *stream = &g_streams[type];
+    FIL *file = &g_file_states[type].file_handle;
+
+    memset(stream, 0, sizeof(*stream));
+    FRESULT res = f_expand(file, g_stream_extents[type], 1);
+    if (res != FR_OK)
+    {
+        g_cache_stats.extent_fails++;
+        return storage_media_error(res) ? res : FR_OK;
+    }
+
+    res = f_sync(file);
+    if (res == FR_OK)
+    {
+        stream->extent = f_size(file);
+        res = storage_stream_resume(type);
+    }
+    if (res != FR_OK)
+    {
+        return res;
+    }
+
+    stream->active = 1;
+    g_cache_stats.extents++;
+    return FR_OK;
+}
+
+// 写出缓存开头的整扇区，再把尾部补0作为一个整扇区写出(尾部仍留在缓存，之后继续追加)，sync为1时同步。
+// 已写数据之后总是紧跟补0的扇区(连续区已写满时除外)，掉电后读取以此为数据末尾
+static FRESULT storage_stream_write(storage_type_t type, uint8_t sync)
+{
+    storage_stream_t *stream = &g_streams[type];
+    storage_cache_t *cache = &g_caches[type];
+    FIL *file = &g_file_states[type].file_handle;
+    uint32_t sectors = cache->length / STORAGE_SECTOR_SIZE;
+    uint32_t tail = cache->length % STORAGE_SECTOR_SIZE;
+    uint32_t end = stream->written + sectors * STORAGE_SECTOR_SIZE;
+    UINT bytes_written;
+
+    if (end + (tail ? STORAGE_SECTOR_SIZE : 0) > stream->extent)
+    {
+        return FR_DENIED;
+    }
+
+    FRESULT res = f_lseek(file, stream->written);
+    if (res == FR_OK && sectors > 0)
+    {
+        res = f_write(file, cache->buffer, sectors * STORAGE_SECTOR_SIZE, &bytes_written);
+        if (res == FR_OK && bytes_written != sectors * STORAGE_SECTOR_SIZE)
+        {
+            res = FR_DENIED;
+        }
+        if (res != FR_OK)
+        {
+            return res;
+        }
+        g_cache_stats.bytes += bytes_written;
+        stream->written += bytes_written;
+        stream->size = stream->written;
+        memmove(cache->buffer, cache->buffer + bytes_written, tail);
+        cache->length = tail;
+    }
+    if (res != FR_OK)
+    {
+        return res;
+    }
+
+    if (end < stream->extent)
+    {
+        memcpy(g_stream_sector, cache->buffer, tail);
+        memset(g_stream_sector + tail, 0, STORAGE_SECTOR_SIZE - tail);
+        res = f_write(file, g_stream_sector, STORAGE_SECTOR_SIZE, &bytes_written);
+        if (res == FR_OK && bytes_written != STORAGE_SECTOR_SIZE)
+        {
+            res = FR_DENIED;
+        }
+        if (res != FR_OK)
+        {
+            return res;
+        }
+        g_cache_stats.bytes += tail;
+        stream->size = stream->written + tail;
+    }
+    return sync ? f_sync(file) : FR_OK;
+}
+
+// 结束流式文件：丢弃已写出的尾部，截断到实际大小释放多余的簇
+static FRESULT storage_stream_close(storage_type_t type)
+{
+    storage_stream_t *stream = &g_streams[type];
+    storage_cache_t *cache = &g_caches[type];
+    FIL *file = &g_file_states[type].file_handle;
+
+    cache->length = 0;
+    cache->records = 0;
+    stream->active = 0;
+
+    file->cltbl = 0;
+    FRESULT res = f_lseek(file, stream->size);
+    if (res == FR_OK)
+    {
+        res = f_truncate(file);
+    }
+    return res;
+}
+
+// 关闭流的当前文件
+static void storage_file_close(storage_type_t type)
+{
+    file_state_t *state = &g_file_states[type];
+    if (state->file_open)
+    {
+        if (g_streams[type].active)
+        {
+            storage_stream_close(type);
+        }
+        f_close(&state->file_handle);
+        state->file_open = 0;
+    }
+}
+
+// 介质异常：丢弃全部文件句柄(重新挂载时FatFs会清除其文件锁)，等待重新挂载
+static void storage_media_fault(void)
+{
+    // 流式文件的连续区保持不变，重新打开后从已写出的整扇区处接着写缓存
+    for (uint8_t i = 0; i < STORAGE_TYPE_COUNT; i++)
+    {
+        g_file_states[i].file_open = 0;
+    }
+    g_sd_fault = 1;
+    g_remount_tick = HAL_GetTick();
+}
+
+// 提交缓存中待写数据，FORCED以外只写到扇区边界，余下部分留待下次提交
+static data_storage_status_t storage_cache_commit(storage_type_t type, storage_commit_mode_t mode);
+
+// 二进制记录文件头放入缓存开头，随首次提交写出
+static void storage_binary_header(storage_cache_t *cache)
+{
+    sample_bin_header_t header = {0};
+    RTC_TimeTypeDef current_rtc_time = {0};
+    RTC_DateTypeDef current_rtc_date = {0};
+    HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
+
+    header.magic = SAMPLE_BIN_MAGIC;
+    header.version = SAMPLE_BIN_VERSION;
+    header.header_size = sizeof(header);
+    header.record_size = SAMPLE_BIN_RECORD_SIZE(ADC_CHANNEL_COUNT);
+    header.channels = ADC_CHANNEL_COUNT;
+    header.value_format = SAMPLE_BIN_FORMAT_Q16;
+    header.tick_hz = SAMPLE_BIN_TICK_HZ;
+    header.start_time = convert_rtc_to_unix_timestamp(&current_rtc_time, &current_rtc_date);
+    header.boot_count = g_boot_count;
+    header.sample_period_ms = (uint32_t)sampling_get_cycle() * 1000;
+    header.crc16 = sample_bin_crc16((const uint8_t *)&header, sizeof(header) - sizeof(header.crc16));
+
+    memcpy(cache->buffer + cache->length, &header, sizeof(header));
+    cache->length += sizeof(header);
+}
+
+// 检查并更新文件名，换文件前先把缓存提交到旧文件
 static data_storage_status_t check_and_update_filename(storage_type_t type)
 {
     if (type >= STORAGE_TYPE_COUNT)
@@ -137,11 +519,17 @@ static data_storage_status_t check_and_update_filename(storage_type_t type)
 
     file_state_t *state = &g_file_states[type];
 
-    if (state->data_count >= 10 || !state->file_exists)
+    if (state->data_count >= g_file_records[type] || !state->file_exists)
     {
+        data_storage_status_t result = storage_cache_commit(type, STORAGE_COMMIT_FORCED);
+        if (result != DATA_STORAGE_OK)
+        {
+            return result;
+        }
+        storage_file_close(type);
 
         char filename[64];
-        data_storage_status_t result = generate_filename(type, filename);
+        result = generate_filename(type, filename);
         if (result != DATA_STORAGE_OK)
         {
             return result;
@@ -150,12 +538,191 @@ static data_storage_status_t check_and_update_filename(storage_type_t type)
         strcpy(state->current_filename, filename);
         state->data_count = 0;
         state->file_exists = 1;
+
+        if (type == STORAGE_BINARY)
+        {
+            storage_binary_header(&g_caches[type]);
+        }
     }
 
     return DATA_STORAGE_OK;
 }
 
-// 写数据到文件
+static data_storage_status_t storage_cache_commit(storage_type_t type, storage_commit_mode_t mode)
+{
+    storage_cache_t *cache = &g_caches[type];
+    uint8_t sync = (mode != STORAGE_COMMIT_CAPACITY);
+    if (cache->length == 0)
+    {
+        return DATA_STORAGE_OK;
+    }
+    if (g_sd_fault)
+    {
+        return DATA_STORAGE_NO_SD; // 数据留在缓存，重新挂载后提交
+    }
+
+    FIL *file = &g_file_states[type].file_handle;
+    FRESULT res = storage_file_open(type);
+
+    if (res == FR_OK && g_streams[type].active)
+    {
+        res = storage_stream_write(type, sync);
+        g_cache_stats.commits++;
+        if (storage_media_error(res))
+        {
+            storage_media_fault();
+            g_cache_stats.errors++;
+            return DATA_STORAGE_NO_SD;
+        }
+        if (res != FR_OK)
+        {
+            g_cache_stats.errors++;
+            return DATA_STORAGE_ERROR;
+        }
+        if (sync)
+        {
+            cache->records = 0;
+        }
+        return DATA_STORAGE_OK;
+    }
+
+    // 先补齐当前扇区，再写整扇区，FatFs对整扇区直接多扇区写卡，不经过FIL缓冲
+    uint32_t length = cache->length;
+    if (res == FR_OK && mode != STORAGE_COMMIT_FORCED)
+    {
+        uint32_t gap = (STORAGE_SECTOR_SIZE - f_tell(file) % STORAGE_SECTOR_SIZE) % STORAGE_SECTOR_SIZE;
+        if (length > gap)
+        {
+            length = gap + (length - gap) / STORAGE_SECTOR_SIZE * STORAGE_SECTOR_SIZE;
+        }
+    }
+
+    UINT bytes_written = 0;
+    if (res == FR_OK)
+    {
+        res = f_write(file, cache->buffer, length, &bytes_written);
+    }
+    // 策略触发与强制提交是持久化点，同步文件大小与目录项；容量触发的中间提交不同步
+    if (res == FR_OK && sync)
+    {
+        res = f_sync(file);
+    }
+
+    g_cache_stats.commits++;
+    if (storage_media_error(res))
+    {
+        storage_media_fault();
+        g_cache_stats.errors++;
+        return DATA_STORAGE_NO_SD;
+    }
+
+    // 其它错误同样丢弃本次数据，避免缓存长期占满
+    memmove(cache->buffer, cache->buffer + length, cache->length - length);
+    cache->length -= length;
+    // 容量触发的部分提交保留原记录数与起始时间；持久化点之后重新计数，
+    // 留在缓存的尾部不再反复触发策略提交，等凑满扇区或强制提交时写出
+    if (cache->length == 0 || sync)
+    {
+        cache->records = 0;
+    }
+
+    g_cache_stats.bytes += bytes_written;
+    if (res != FR_OK || bytes_written != length)
+    {
+        g_cache_stats.errors++;
+        return DATA_STORAGE_ERROR;
+    }
+
+    return DATA_STORAGE_OK;
+}
+
+// 写一条记录：追加到该流的缓存，缓存放不下时先提交，持久化策略的提交由存储任务进行；
+// newline为1时在记录后补换行。记录进入缓存即返回成功，掉电预警期间直写，其提交失败计入errors
+static data_storage_status_t storage_write_record(storage_type_t type, const void *data, uint32_t length, uint8_t newline)
+{
+    data_storage_status_t result = check_and_update_filename(type);
+    if (result != DATA_STORAGE_OK)
+    {
+        return result;
+    }
+
+    storage_cache_t *cache = &g_caches[type];
+    uint32_t size = length + newline;
+
+    // 放不下时先按扇区边界提交，仍放不下则全部提交
+    if (cache->length + size > cache->capacity)
+    {
+        result = storage_cache_commit(type, STORAGE_COMMIT_CAPACITY);
+        if (result == DATA_STORAGE_OK && cache->length + size > cache->capacity)
+        {
+            result = storage_cache_commit(type, STORAGE_COMMIT_FORCED);
+        }
+        if (result != DATA_STORAGE_OK)
+        {
+            return result;
+        }
+    }
+    if (size > cache->capacity)
+    {
+        return DATA_STORAGE_INVALID;
+    }
+
+    if (cache->records == 0)
+    {
+        cache->first_tick = HAL_GetTick();
+    }
+    memcpy(cache->buffer + cache->length, data, length);
+    if (newline)
+    {
+        cache->buffer[cache->length + length] = '\n';
+    }
+    cache->length += size;
+    cache->records++;
+    g_cache_stats.records++;
+    g_file_states[type].data_count++;
+
+    if (g_power_low)
+    {
+        storage_cache_commit(type, STORAGE_COMMIT_FORCED);
+    }
+
+    return DATA_STORAGE_OK;
+}
+
+// 记录入队，由存储任务写入；生产者之间须已串行化(裸机主循环或RTOS下的app_lock)
+static data_storage_status_t storage_enqueue(storage_type_t type, const void *data, uint32_t length, uint8_t newline)
+{
+    storage_msg_t msg = {(uint8_t)type, newline, (uint16_t)length};
+
+    if (length > STORAGE_MSG_MAX)
+    {
+        return DATA_STORAGE_INVALID;
+    }
+    if (spsc_ring_free(&g_queue) < sizeof(msg) + length)
+    {
+        g_cache_stats.dropped++;
+        g_queue_busy = 1;
+        return DATA_STORAGE_FULL;
+    }
+
+    // 头部与内容分两次发布，存储任务等内容到齐后才取出
+    spsc_ring_write(&g_queue, (const uint8_t *)&msg, sizeof(msg));
+    spsc_ring_write(&g_queue, (const uint8_t *)data, length);
+    g_cache_stats.queued++;
+
+    uint32_t used = spsc_ring_used(&g_queue);
+    if (used > g_cache_stats.queue_peak)
+    {
+        g_cache_stats.queue_peak = used;
+    }
+    if (used >= STORAGE_QUEUE_HIGH)
+    {
+        g_queue_busy = 1;
+    }
+    return DATA_STORAGE_OK;
+}
+
+// 写文本数据到文件：入队，由存储任务写入
 static data_storage_status_t write_data_to_file(storage_type_t type, const char *data)
 {
     if (type >= STORAGE_TYPE_COUNT || data == NULL)
@@ -163,83 +730,249 @@ static data_storage_status_t write_data_to_file(storage_type_t type, const char
         return DATA_STORAGE_INVALID;
     }
 
-    data_storage_status_t result = check_and_update_filename(type);
+    return storage_enqueue(type, data, strlen(data), 1);
+}
+
+// 补上文件内序号与CRC后写入二进制记录
+static data_storage_status_t storage_write_binary_record(uint8_t *record, uint32_t length)
+{
+    // 写入前data_count即本条在文件内的序号，换文件时由check_and_update_filename清零
+    data_storage_status_t result = check_and_update_filename(STORAGE_BINARY);
     if (result != DATA_STORAGE_OK)
     {
         return result;
     }
+    uint16_t sequence = g_file_states[STORAGE_BINARY].data_count;
+    memcpy(record + length - 4, &sequence, 2);
+    uint16_t crc = sample_bin_crc16(record, length - 2);
+    memcpy(record + length - 2, &crc, 2);
 
-    file_state_t *state = &g_file_states[type];
+    return storage_write_record(STORAGE_BINARY, record, length, 0);
+}
 
-    char full_path[96];
-    sprintf(full_path, "%s/%s", g_directory_names[type], state->current_filename);
-    FIL file_handle;
-    FRESULT res = f_open(&file_handle, full_path, FA_OPEN_ALWAYS | FA_WRITE);
-    if (res != FR_OK)
+// 复制出队首的一条完整记录(头部在前，内容紧随其后)但不出队，队列空时返回0
+static uint8_t storage_queue_peek(uint8_t *frame)
+{
+    storage_msg_t *msg = (storage_msg_t *)frame;
+
+    if (spsc_ring_peek(&g_queue, frame, sizeof(*msg)) < sizeof(*msg) ||
+        spsc_ring_used(&g_queue) < sizeof(*msg) + msg->length)
     {
-        return DATA_STORAGE_ERROR;
+        return 0;
     }
 
-    res = f_lseek(&file_handle, f_size(&file_handle));
-    if (res != FR_OK)
+    spsc_ring_peek(&g_queue, frame, sizeof(*msg) + msg->length);
+    return 1;
+}
+
+// 成批写出队列中的记录，写满limit条、用完budget_ms或进行过一次缓存提交即返回，余下的留给下次。
+// SD卡异常写不进缓存的记录留在队列，重新挂载后再写；其它原因写入失败的记录出队并计入dropped
+static void storage_queue_drain(uint32_t limit, uint32_t budget_ms)
+{
+    static __ALIGNED(4) uint8_t frame[sizeof(storage_msg_t) + STORAGE_MSG_MAX];
+    const storage_msg_t *msg = (const storage_msg_t *)frame;
+    uint8_t *payload = frame + sizeof(storage_msg_t);
+    uint32_t start = HAL_GetTick();
+    uint32_t commits = g_cache_stats.commits;
+
+    for (uint32_t n = 0; n < limit && storage_queue_peek(frame); n++)
     {
-        f_close(&file_handle);
-        return DATA_STORAGE_ERROR;
+        data_storage_status_t result;
+        if (msg->type == STORAGE_BINARY)
+        {
+            result = storage_write_binary_record(payload, msg->length);
+        }
+        else
+        {
+            result = storage_write_record((storage_type_t)msg->type, payload, msg->length, msg->newline);
+        }
+
+        if (result == DATA_STORAGE_NO_SD)
+        {
+            break;
+        }
+        spsc_ring_release(&g_queue, sizeof(storage_msg_t) + msg->length);
+        if (result != DATA_STORAGE_OK)
+        {
+            g_cache_stats.dropped++;
+        }
+
+        // 本条记录触发了缓存提交(换文件或缓存已满)即结束本次写入
+        if (HAL_GetTick() - start >= budget_ms || (budget_ms != STORAGE_DRAIN_ALL && g_cache_stats.commits != commits))
+        {
+            break;
+        }
     }
 
-    UINT bytes_written;
-    res = f_write(&file_handle, data, strlen(data), &bytes_written);
-    if (res != FR_OK || bytes_written != strlen(data))
+    if (spsc_ring_used(&g_queue) <= STORAGE_QUEUE_LOW)
     {
-        return DATA_STORAGE_ERROR;
+        g_queue_busy = 0;
     }
+}
+
+// 提交所有流的缓存数据
+static data_storage_status_t storage_flush_all(void)
+{
+    data_storage_status_t status = DATA_STORAGE_OK;
 
-    res = f_write(&file_handle, "\n", 1, &bytes_written);
-    if (res != FR_OK || bytes_written != 1)
+    for (uint8_t i = 0; i < STORAGE_TYPE_COUNT; i++)
     {
-        f_close(&file_handle);
-        return DATA_STORAGE_ERROR;
+        if (storage_cache_commit((storage_type_t)i, STORAGE_COMMIT_FORCED) != DATA_STORAGE_OK)
+        {
+            status = DATA_STORAGE_ERROR;
+        }
     }
 
-    f_sync(&file_handle);
-    f_close(&file_handle);
-
-    state->data_count++;
+    return status;
+}
 
+// 请求提交全部数据：存储任务写空记录队列后提交各流缓存
+data_storage_status_t data_storage_flush(void)
+{
+    g_flush_request = 1;
     return DATA_STORAGE_OK;
 }
 
+// 记录队列积压，供界面提示
+uint8_t data_storage_busy(void)
+{
+    return g_queue_busy;
+}
+
+// 设置缓存持久化策略
+void data_storage_set_cache_policy(const storage_cache_policy_t *policy)
+{
+    g_cache_policy = *policy;
+    if (g_cache_policy.max_records == 0)
+    {
+        g_cache_policy.max_records = 1;
+    }
+}
+
+void data_storage_get_cache_policy(storage_cache_policy_t *policy)
+{
+    *policy = g_cache_policy;
+}
+
+// 打印缓存策略、占用与提交统计
+void data_storage_cache_report(void)
+{
+    my_printf(&huart1, "cache policy: records %d age %lums stop flush %s\r\n",
+              g_cache_policy.max_records, g_cache_policy.max_age_ms, g_cache_policy.flush_on_stop ? "on" : "off");
+    for (uint8_t i = 0; i < STORAGE_TYPE_COUNT; i++)
+    {
+        my_printf(&huart1, "%-10s %4d/%4d bytes %2d records\r\n",
+                  g_directory_names[i], g_caches[i].length, g_caches[i].capacity, g_caches[i].records);
+    }
+    my_printf(&huart1, "records %lu commits %lu bytes %lu errors %lu power fail %lu\r\n",
+              g_cache_stats.records, g_cache_stats.commits, g_cache_stats.bytes, g_cache_stats.errors,
+              g_cache_stats.power_fails);
+    my_printf(&huart1, "queue %lu/%d bytes peak %lu, %lu queued %lu dropped%s\r\n",
+              spsc_ring_used(&g_queue), STORAGE_QUEUE_SIZE, g_cache_stats.queue_peak,
+              g_cache_stats.queued, g_cache_stats.dropped, g_queue_busy ? ", busy" : "");
+    my_printf(&huart1, "sd card %s, %lu remounts\r\n", g_sd_fault ? "missing" : "ok", g_cache_stats.remounts);
+    sd_diskio_stats_t sd_stats;
+    sd_diskio_get_stats(&sd_stats);
+    my_printf(&huart1, "sd dma %lu transfers, %lu unaligned, %lu errors, %lums card busy\r\n",
+              sd_stats.transfers, sd_stats.unaligned, sd_stats.errors, sd_stats.busy_ms);
+    my_printf(&huart1, "extents %lu (%lu fallback)", g_cache_stats.extents, g_cache_stats.extent_fails);
+    for (uint8_t i = 0; i < STORAGE_TYPE_COUNT; i++)
+    {
+        if (g_streams[i].active)
+        {
+            my_printf(&huart1, ", %s %lu/%lu bytes", g_directory_names[i],
+                      g_streams[i].size, g_streams[i].extent);
+        }
+    }
+    my_printf(&huart1, "\r\n");
+}
+
+// 掉电预警：VDD低于PVD阈值时置位，由存储任务立即提交缓存
+void HAL_PWR_PVDCallback(void)
+{
+    g_power_low = __HAL_PWR_GET_FLAG(PWR_FLAG_PVDO) ? 1 : 0;
+    if (g_power_low)
+    {
+        g_power_fail_pending = 1;
+        g_cache_stats.power_fails++;
+    }
+}
+
+// 使能PVD，VDD跌落与恢复均产生中断
+static void storage_power_monitor_init(void)
+{
+    PWR_PVDTypeDef pvd = {0};
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    pvd.PVDLevel = STORAGE_PVD_LEVEL;
+    pvd.Mode = PWR_PVD_MODE_IT_RISING_FALLING;
+    HAL_PWR_ConfigPVD(&pvd);
+    HAL_PWR_EnablePVD();
+
+    HAL_NVIC_SetPriority(PVD_IRQn, STORAGE_PVD_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(PVD_IRQn);
+}
+
+// 追加各通道电压列
+static void format_voltage_columns(const float *voltages, char *formatted_data)
+{
+    char *p = formatted_data + strlen(formatted_data);
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        p += sprintf(p, " %.1fV", voltages[ch]);
+    }
+}
+
+// 追加各通道波形参数列（有效值/峰峰值/峰值因数/THD）
+static void format_wave_columns(const sample_record_t *record, char *formatted_data)
+{
+    char *p = formatted_data + strlen(formatted_data);
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        const sample_wave_t *wave = &record->wave[ch];
+        if (wave->valid & SAMPLE_WAVE_STATS)
+        {
+            p += sprintf(p, " rms%d %.2fV pp%d %.2fV cf%d %.2f", ch, wave->rms, ch, wave->peak_to_peak, ch, wave->crest_factor);
+        }
+        if (wave->valid & SAMPLE_WAVE_THD)
+        {
+            p += sprintf(p, " thd%d %.1f%%", ch, wave->thd);
+        }
+    }
+}
+
 // 格式化采样数据
-static data_storage_status_t format_sample_data(float voltage, char *formatted_data)
+static data_storage_status_t format_sample_data(const sample_record_t *record, char *formatted_data)
 {
-    if (formatted_data == NULL)
+    if (record == NULL || formatted_data == NULL)
     {
         return DATA_STORAGE_INVALID;
     }
 
-    RTC_TimeTypeDef current_rtc_time = {0};
-    RTC_DateTypeDef current_rtc_date = {0};
-    HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
-    HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
-
-    sprintf(formatted_data, "%04d-%02d-%02d %02d:%02d:%02d %.1fV",
-            current_rtc_date.Year + 2000,
-            current_rtc_date.Month,
-            current_rtc_date.Date,
-            current_rtc_time.Hours,
-            current_rtc_time.Minutes,
-            current_rtc_time.Seconds,
-            voltage);
+    sprintf(formatted_data, "%04d-%02d-%02d %02d:%02d:%02d",
+            record->rtc_date.Year + 2000,
+            record->rtc_date.Month,
+            record->rtc_date.Date,
+            record->rtc_time.Hours,
+            record->rtc_time.Minutes,
+            record->rtc_time.Seconds);
+    format_voltage_columns(record->voltage, formatted_data);
+    if (record->flags & SAMPLE_REC_WAVE)
+    {
+        format_wave_columns(record, formatted_data);
+    }
 
     return DATA_STORAGE_OK;
 }
 
 // 写采样数据
-data_storage_status_t data_storage_write_sample(float voltage)
+data_storage_status_t data_storage_write_sample(const sample_record_t *record)
 {
-    char formatted_data[128];
+    char formatted_data[SAMPLE_LINE_SIZE];
 
-    data_storage_status_t result = format_sample_data(voltage, formatted_data);
+    data_storage_status_t result = format_sample_data(record, formatted_data);
     if (result != DATA_STORAGE_OK)
     {
         return result;
@@ -249,7 +982,7 @@ data_storage_status_t data_storage_write_sample(float voltage)
 }
 
 // 格式化超限数据
-static data_storage_status_t format_overlimit_data(float voltage, float limit, char *formatted_data)
+static data_storage_status_t format_overlimit_data(uint8_t channel, float voltage, float limit, char *formatted_data)
 {
     if (formatted_data == NULL)
     {
@@ -261,13 +994,14 @@ static data_storage_status_t format_overlimit_data(float voltage, float limit, c
     HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
     HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
 
-    sprintf(formatted_data, "%04d-%02d-%02d %02d:%02d:%02d %.0fV limit %.0fV",
+    sprintf(formatted_data, "%04d-%02d-%02d %02d:%02d:%02d ch%d %.0fV limit %.0fV",
             current_rtc_date.Year + 2000,
             current_rtc_date.Month,
             current_rtc_date.Date,
             current_rtc_time.Hours,
             current_rtc_time.Minutes,
             current_rtc_time.Seconds,
+            channel,
             voltage,
             limit);
 
@@ -275,11 +1009,16 @@ static data_storage_status_t format_overlimit_data(float voltage, float limit, c
 }
 
 // 写超限数据
-data_storage_status_t data_storage_write_overlimit(float voltage, float limit)
+data_storage_status_t data_storage_write_overlimit(uint8_t channel, float voltage, float limit)
 {
     char formatted_data[128];
 
-    data_storage_status_t result = format_overlimit_data(voltage, limit, formatted_data);
+    if (channel >= ADC_CHANNEL_COUNT)
+    {
+        return DATA_STORAGE_INVALID;
+    }
+
+    data_storage_status_t result = format_overlimit_data(channel, voltage, limit, formatted_data);
     if (result != DATA_STORAGE_OK)
     {
         return result;
@@ -328,31 +1067,25 @@ data_storage_status_t data_storage_write_log(const char *operation)
 }
 
 // 格式化隐藏数据
-static data_storage_status_t format_hidedata(float voltage, uint8_t is_overlimit, char *formatted_data)
+static data_storage_status_t format_hidedata(const sample_record_t *record, char *formatted_data)
 {
-    if (formatted_data == NULL)
+    if (record == NULL || formatted_data == NULL)
     {
         return DATA_STORAGE_INVALID;
     }
 
-    RTC_TimeTypeDef current_rtc_time = {0};
-    RTC_DateTypeDef current_rtc_date = {0};
-    HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
-    HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
-
     char original_line[128];
-    sprintf(original_line, "%04d-%02d-%02d %02d:%02d:%02d %.1fV",
-            current_rtc_date.Year + 2000,
-            current_rtc_date.Month,
-            current_rtc_date.Date,
-            current_rtc_time.Hours,
-            current_rtc_time.Minutes,
-            current_rtc_time.Seconds,
-            voltage);
-
-    uint32_t timestamp = convert_rtc_to_unix_timestamp(&current_rtc_time, &current_rtc_date);
-    char hex_output[32];
-    format_hex_output(timestamp, voltage, is_overlimit, hex_output);
+    sprintf(original_line, "%04d-%02d-%02d %02d:%02d:%02d",
+            record->rtc_date.Year + 2000,
+            record->rtc_date.Month,
+            record->rtc_date.Date,
+            record->rtc_time.Hours,
+            record->rtc_time.Minutes,
+            record->rtc_time.Seconds);
+    format_voltage_columns(record->voltage, original_line);
+
+    char hex_output[HEX_OUTPUT_SIZE];
+    format_hex_channels(record->time, record->voltage, record->overlimit_mask, hex_output);
 
     sprintf(formatted_data, "%s\nhide: %s", original_line, hex_output);
 
@@ -360,11 +1093,11 @@ static data_storage_status_t format_hidedata(float voltage, uint8_t is_overlimit
 }
 
 // 写隐藏数据
-data_storage_status_t data_storage_write_hidedata(float voltage, uint8_t is_overlimit)
+data_storage_status_t data_storage_write_hidedata(const sample_record_t *record)
 {
     char formatted_data[256];
 
-    data_storage_status_t result = format_hidedata(voltage, is_overlimit, formatted_data);
+    data_storage_status_t result = format_hidedata(record, formatted_data);
     if (result != DATA_STORAGE_OK)
     {
         return result;
@@ -373,6 +1106,227 @@ data_storage_status_t data_storage_write_hidedata(float voltage, uint8_t is_over
     return write_data_to_file(STORAGE_HIDEDATA, formatted_data);
 }
 
+// 写二进制采样记录：采样时刻精确到毫秒，电压按Q16.16保存，不丢精度
+data_storage_status_t data_storage_write_binary(const sample_record_t *sample)
+{
+    uint8_t record[SAMPLE_BIN_RECORD_SIZE(ADC_CHANNEL_COUNT)];
+    uint8_t *p = record;
+
+    if (sample == NULL)
+    {
+        return DATA_STORAGE_INVALID;
+    }
+
+    uint32_t time = sample->time;
+    uint16_t ticks = (uint16_t)((uint32_t)sample->ms * SAMPLE_BIN_TICK_HZ / 1000);
+    uint8_t flags = 0;
+    if (sample->flags & SAMPLE_REC_WAVE)
+    {
+        flags |= SAMPLE_BIN_FLAG_WAVE;
+    }
+    if (g_output_format == OUTPUT_FORMAT_HIDDEN)
+    {
+        flags |= SAMPLE_BIN_FLAG_HIDDEN;
+    }
+
+    memcpy(p, &time, 4);
+    memcpy(p + 4, &ticks, 2);
+    p[6] = sample->overlimit_mask;
+    p[7] = flags;
+    p += SAMPLE_BIN_VALUE_OFFSET;
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float scaled = sample->voltage[ch] * 65536.0f;
+        int32_t value;
+        if (scaled >= 2147483647.0f)
+            value = INT32_MAX;
+        else if (scaled <= -2147483648.0f)
+            value = INT32_MIN;
+        else
+            value = (int32_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+        memcpy(p, &value, 4);
+        p += 4;
+    }
+
+    // 序号与CRC在存储任务写入时补上
+    memset(p, 0, 4);
+
+    return storage_enqueue(STORAGE_BINARY, record, sizeof(record), 0);
+}
+
+// 开关二进制采样记录流
+void data_storage_set_binary(uint8_t enable)
+{
+    g_binary_enabled = enable ? 1 : 0;
+}
+
+uint8_t data_storage_get_binary(void)
+{
+    return g_binary_enabled;
+}
+
+// 突发记录写出协程：冻结的触发记录逐块写入overLimit/burst<时间>.bin，
+// 每写一块让出一次，避免整段记录阻塞其它任务；写出期间触发被撤销则放弃本次记录
+static char burst_write_thread(pt_t *pt)
+{
+    static adc_burst_header_t header;
+    static uint32_t trigger_tick;
+    static uint16_t blocks;
+    static uint16_t index;
+    static char datetime_str[16];
+    static FIL file_handle;
+    static FRESULT res;
+    static uint8_t file_open;
+    UINT bytes_written;
+
+    PT_BEGIN(pt);
+
+    PT_WAIT_UNTIL(pt, adc_trigger_get_state() == ADC_TRIGGER_FROZEN);
+
+    blocks = adc_trigger_get_burst(&header, &trigger_tick);
+    if (blocks == 0)
+    {
+        adc_trigger_release();
+        PT_EXIT(pt);
+    }
+
+    RTC_TimeTypeDef current_rtc_time = {0};
+    RTC_DateTypeDef current_rtc_date = {0};
+    HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
+    header.timestamp = convert_rtc_to_unix_timestamp(&current_rtc_time, &current_rtc_date) -
+                       (HAL_GetTick() - trigger_tick) / 1000;
+
+    char full_path[64];
+    generate_datetime_string(datetime_str);
+    sprintf(full_path, "%s/burst%s.bin", g_directory_names[STORAGE_OVERLIMIT], datetime_str);
+
+    res = f_open(&file_handle, full_path, FA_CREATE_ALWAYS | FA_WRITE);
+    file_open = (res == FR_OK);
+    if (file_open)
+    {
+        // 记录大小已知，整段预分配为连续簇，逐块写入时不再分配簇、更新FAT；
+        // 无连续空间时按普通方式边写边分配
+        if (f_expand(&file_handle, sizeof(header) + (FSIZE_t)blocks * ADC_BLOCK_SAMPLES * sizeof(uint16_t), 1) != FR_OK)
+        {
+            g_cache_stats.extent_fails++;
+        }
+        else
+        {
+            g_cache_stats.extents++;
+        }
+        res = f_write(&file_handle, &header, sizeof(header), &bytes_written);
+    }
+
+    for (index = 0; index < blocks && res == FR_OK; index++)
+    {
+        PT_YIELD(pt);
+        if (adc_trigger_get_state() != ADC_TRIGGER_FROZEN)
+        {
+            res = FR_DENIED;
+            break;
+        }
+        res = f_write(&file_handle, adc_trigger_get_block(index), ADC_BLOCK_SAMPLES * sizeof(uint16_t), &bytes_written);
+        if (res == FR_OK && bytes_written != ADC_BLOCK_SAMPLES * sizeof(uint16_t))
+        {
+            res = FR_DENIED;
+        }
+    }
+
+    if (file_open)
+    {
+        // 中途放弃时截掉预分配而未写入的部分
+        f_truncate(&file_handle);
+        f_close(&file_handle);
+    }
+
+    if (res == FR_OK)
+    {
+        // 协程在存储任务中运行，日志直接写入缓存，不经记录队列
+        char log_msg[64];
+        char formatted_data[96];
+        sprintf(log_msg, "burst ch%d saved burst%s.bin", header.trigger_channel, datetime_str);
+        format_log_data(log_msg, formatted_data);
+        storage_write_record(STORAGE_LOG, formatted_data, strlen(formatted_data), 1);
+    }
+
+    // 采样仍在进行则重新布防，否则撤销触发
+    if (sampling_get_state() == SAMPLING_ACTIVE)
+    {
+        adc_trigger_release();
+    }
+    else
+    {
+        adc_trigger_disarm();
+    }
+
+    PT_END(pt);
+}
+
+// 存储任务：成批写出记录队列，按持久化策略提交缓存，推进突发记录写出协程。
+// RTOS模式下单独运行在最低优先级的sd线程中，SD卡延迟只拖慢本任务
+void data_storage_task(void)
+{
+    static pt_t burst_pt = {0};
+    static uint8_t was_sampling = 0;
+    uint8_t sampling = (sampling_get_state() == SAMPLING_ACTIVE);
+    uint32_t now = HAL_GetTick();
+    uint32_t commits;
+
+    // SD卡异常后定期重新挂载，成功后按原文件名重新打开并提交积压数据
+    if (g_sd_fault && now - g_remount_tick >= STORAGE_REMOUNT_MS)
+    {
+        g_remount_tick = now;
+        if (storage_mount() == DATA_STORAGE_OK)
+        {
+            g_sd_fault = 0;
+            g_cache_stats.remounts++;
+            storage_flush_all();
+        }
+    }
+
+    if (was_sampling && !sampling && g_cache_policy.flush_on_stop)
+    {
+        g_flush_request = 1;
+    }
+
+    commits = g_cache_stats.commits;
+    if (g_power_fail_pending)
+    {
+        // 掉电预警：不受时间预算限制，写空队列后立即提交
+        g_power_fail_pending = 0;
+        storage_queue_drain(STORAGE_DRAIN_ALL, STORAGE_DRAIN_ALL);
+        storage_flush_all();
+    }
+    else
+    {
+        storage_queue_drain(STORAGE_DRAIN_RECORDS, STORAGE_DRAIN_MS);
+    }
+
+    // 提交请求之前入队的记录全部写入后再提交
+    if (g_flush_request && spsc_ring_used(&g_queue) == 0)
+    {
+        g_flush_request = 0;
+        storage_flush_all();
+    }
+    else if (g_cache_stats.commits == commits)
+    {
+        // 本次写入未提交过时，提交一个达到记录数或滞留时间的缓存(只写整扇区)，其余留给下次
+        for (uint8_t i = 0; i < STORAGE_TYPE_COUNT; i++)
+        {
+            if (g_caches[i].records > 0 && (g_caches[i].records >= g_cache_policy.max_records ||
+                                            now - g_caches[i].first_tick >= g_cache_policy.max_age_ms))
+            {
+                storage_cache_commit((storage_type_t)i, STORAGE_COMMIT_POLICY);
+                break;
+            }
+        }
+    }
+    was_sampling = sampling;
+
+    burst_write_thread(&burst_pt);
+}
+
 // 生成日期时间字符串
 data_storage_status_t generate_datetime_string(char *datetime_str)
 {
@@ -417,7 +1371,7 @@ data_storage_status_t generate_filename(storage_type_t type, char *filename)
         {
             return result;
         }
-        sprintf(filename, "%s%s.txt", g_filename_prefixes[type], datetime_str);
+        sprintf(filename, "%s%s.%s", g_filename_prefixes[type], datetime_str, type == STORAGE_BINARY ? "bin" : "txt");
     }
 
     return DATA_STORAGE_OK;
@@ -439,7 +1393,18 @@ static data_storage_status_t create_default_config_ini(void)
     {
         return DATA_STORAGE_ERROR;
     }
-    const char *default_content = "[Ratio]\r\nCh0 = 1.99\r\n\r\n[Limit]\r\nCh0 = 10.11\r\n";
+    static char default_content[32 + ADC_CHANNEL_COUNT * 32];
+    char *p = default_content;
+    p += sprintf(p, "[Ratio]\r\n");
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        p += sprintf(p, "Ch%d = 1.99\r\n", ch);
+    }
+    p += sprintf(p, "\r\n[Limit]\r\n");
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        p += sprintf(p, "Ch%d = 10.11\r\n", ch);
+    }
     UINT bw;
     f_write(&ini_file, default_content, strlen(default_content), &bw);
     f_close(&ini_file);
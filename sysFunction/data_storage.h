@@ -3,6 +3,8 @@
 
 #include "mydefine.h" 
 #include "ff.h"       
+#include "adc_channel.h"
+#include "sample_bus.h"
 
 typedef enum 
 {
@@ -10,7 +12,8 @@ typedef enum
     STORAGE_OVERLIMIT = 1, 
     STORAGE_LOG = 2,      
     STORAGE_HIDEDATA = 3, 
-    STORAGE_TYPE_COUNT = 4 
+    STORAGE_BINARY = 4,   // 二进制采样记录，格式见sample_bin.h
+    STORAGE_TYPE_COUNT = 5 
 } storage_type_t;
 
 typedef enum 
@@ -25,16 +28,34 @@ typedef enum
 typedef struct 
 {
     char current_filename[32]; 
-    uint8_t data_count;        
+    uint16_t data_count;       
     uint8_t file_exists;       
+    uint8_t file_open;         // file_handle保持打开，换文件或SD卡异常时关闭
+    FIL file_handle;           
 } file_state_t;
 
+typedef struct 
+{
+    uint8_t max_records;   // 缓存记录数达到后提交到扇区边界并同步，1为每条记录后提交
+    uint32_t max_age_ms;   // 最早一条缓存记录滞留超过该时长时提交到扇区边界并同步
+    uint8_t flush_on_stop; // 停止采样时提交全部缓存
+} storage_cache_policy_t;
+
 
 data_storage_status_t data_storage_init(void);                                         
-data_storage_status_t data_storage_write_sample(float voltage);                        
-data_storage_status_t data_storage_write_overlimit(float voltage, float limit);         
-data_storage_status_t data_storage_write_log(const char *operation);                    
-data_storage_status_t data_storage_write_hidedata(float voltage, uint8_t is_overlimit); 
+data_storage_status_t data_storage_write_sample(const sample_record_t *record);                          
+data_storage_status_t data_storage_write_overlimit(uint8_t channel, float voltage, float limit);         
+data_storage_status_t data_storage_write_log(const char *operation);                                     
+data_storage_status_t data_storage_write_hidedata(const sample_record_t *record);                        
+data_storage_status_t data_storage_write_binary(const sample_record_t *record);                          
+void data_storage_set_binary(uint8_t enable);                                                           
+uint8_t data_storage_get_binary(void);                                                                  
+void data_storage_task(void);                                                                           
+data_storage_status_t data_storage_flush(void);                                                         
+uint8_t data_storage_busy(void);                                                                        
+void data_storage_set_cache_policy(const storage_cache_policy_t *policy);                               
+void data_storage_get_cache_policy(storage_cache_policy_t *policy);                                     
+void data_storage_cache_report(void);                                                                   
 data_storage_status_t data_storage_test(void);                                         
 
 
@@ -107,8 +107,14 @@ ini_status_t ini_parse_line(const char *line, ini_config_t *config)
     ini_trim_string(key);
     ini_trim_string(value);
 
-    if (strcmp(key, "Ch0") == 0)
+    if (key[0] == 'C' && key[1] == 'h' && isdigit((unsigned char)key[2]) && key[3] == '\0')
     {
+        uint8_t channel = key[2] - '0';
+        if (channel >= ADC_CHANNEL_COUNT)
+        {
+            return INI_OK;
+        }
+
         float parsed_value;
         if (ini_parse_float(value, &parsed_value) != INI_OK)
         {
@@ -117,13 +123,13 @@ ini_status_t ini_parse_line(const char *line, ini_config_t *config)
 
         if (current_state == PARSE_RATIO)
         {
-            config->ratio = parsed_value;
-            config->ratio_found = 1;
+            config->ratio[channel] = parsed_value;
+            config->ratio_found |= (1 << channel);
         }
         else if (current_state == PARSE_LIMIT)
         {
-            config->limit = parsed_value;
-            config->limit_found = 1;
+            config->limit[channel] = parsed_value;
+            config->limit_found |= (1 << channel);
         }
     }
 
@@ -141,8 +147,8 @@ ini_status_t ini_parse_file(const char *filename, ini_config_t *config)
     char line_buffer[128];
     UINT bytes_read;
 
-    config->ratio = 0.0f;
-    config->limit = 0.0f;
+    memset(config->ratio, 0, sizeof(config->ratio));
+    memset(config->limit, 0, sizeof(config->limit));
     config->ratio_found = 0;
     config->limit_found = 0;
 
@@ -3,6 +3,7 @@
 
 #include "stdint.h" 
 #include "ff.h"    
+#include "adc_channel.h"
 
 typedef enum 
 {
@@ -15,10 +16,10 @@ typedef enum
 
 typedef struct 
 {
-    float ratio;         
-    float limit;        
-    uint8_t ratio_found; 
-    uint8_t limit_found; 
+    float ratio[ADC_CHANNEL_COUNT]; 
+    float limit[ADC_CHANNEL_COUNT]; 
+    uint8_t ratio_found;            // 按位标记已读到的ChN
+    uint8_t limit_found;            // 按位标记已读到的ChN
 } ini_config_t;
 
 ini_status_t ini_parse_file(const char *filename, ini_config_t *config); 
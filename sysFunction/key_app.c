@@ -50,9 +50,7 @@ void key_proc(void)
                 my_printf(&huart1, "sample cycle: %ds\r\n", (int)cycle);
 
                 extern uint8_t g_sampling_output_enabled;
-                extern uint32_t g_last_output_time;
                 g_sampling_output_enabled = 1;
-                g_last_output_time = HAL_GetTick();
 
                 char log_msg[64];
                 sprintf(log_msg, "sample start - cycle %ds (key1)", (int)cycle);
@@ -36,17 +36,20 @@ void led_disp(uint8_t *ucLed)
 // LED任务
 void led_task(void)
 {
-    static uint32_t led1_blink_time = 0;
+    static periodic_timer_t led1_blink_timer = {0};
     static uint8_t led1_blink_state = 0;
+    static uint8_t led1_blink_running = 0;
 
     if (sampling_get_state() == SAMPLING_ACTIVE)
     {
-
-        uint32_t current_time = HAL_GetTick();
-        if (current_time - led1_blink_time >= 500)
+        if (!led1_blink_running)
+        {
+            periodic_timer_start(&led1_blink_timer, 500, PERIODIC_SKIP, HAL_GetTick());
+            led1_blink_running = 1;
+        }
+        if (periodic_timer_expired(&led1_blink_timer, HAL_GetTick()))
         {
             led1_blink_state ^= 1;
-            led1_blink_time = current_time;
         }
         ucLed[0] = led1_blink_state;
     }
@@ -54,9 +57,12 @@ void led_task(void)
     {
         ucLed[0] = 0;
         led1_blink_state = 0;
+        led1_blink_running = 0;
     }
 
-    if (sampling_check_overlimit() && sampling_get_state() == SAMPLING_ACTIVE)
+    // 最近一次采样有通道超限
+    sample_record_t record;
+    if (sampling_get_state() == SAMPLING_ACTIVE && sample_bus_latest(&record) && record.overlimit_mask)
     {
         ucLed[1] = 1;
     }
@@ -65,5 +71,8 @@ void led_task(void)
 
         ucLed[1] = 0;
     }
+
+    // 存储记录队列积压：SD卡写入跟不上记录产生速度
+    ucLed[2] = data_storage_busy();
     led_disp(ucLed);
 }
@@ -19,7 +19,9 @@
 #include "lfs_port.h"
 #include "gd25qxx.h"
 #include "scheduler.h"
+#include "app_threads.h"
 #include "ringbuffer.h"
+#include "spsc_ring.h"
 #include "arm_math.h"
 #include "ff.h"    
 #include "fatfs.h" 
@@ -39,11 +41,8 @@
 extern uint16_t uart_rx_index;
 extern uint32_t uart_rx_ticks;
 extern uint8_t uart_rx_buffer[128];
-extern uint8_t uart_rx_dma_buffer[128];
 extern UART_HandleTypeDef huart1;
 extern DMA_HandleTypeDef hdma_usart1_rx;
-extern struct rt_ringbuffer uart_ringbuffer;
-extern uint8_t ringbuffer_pool[128];
 extern uint8_t uart_send_flag;
 extern uint8_t wave_analysis_flag;
 extern struct lfs_config cfg;
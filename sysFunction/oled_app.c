@@ -31,29 +31,37 @@ int oled_printf(uint8_t x, uint8_t y, const char *format, ...)
 void oled_task(void)
 {
   static uint8_t last_display_state = 0xFF;
+  static uint32_t last_sequence = 0;
   uint8_t current_state = 0;
 
   if (sampling_get_state() == SAMPLING_ACTIVE)
   {
     current_state = 1;
 
-    RTC_TimeTypeDef current_rtc_time = {0};
-    RTC_DateTypeDef current_rtc_date = {0};
-    HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
-    HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
-
-    float voltage = sampling_get_voltage();
-
-    oled_printf(0, 0, "%02d:%02d:%02d      ",
-                current_rtc_time.Hours,
-                current_rtc_time.Minutes,
-                current_rtc_time.Seconds);
-
-    oled_printf(0, 1, "%.2f V  ", voltage);
+    // 显示最近一次采样的时间与通道0电压，有新采样记录时才刷新
+    sample_record_t record;
+    uint32_t sequence = sample_bus_latest(&record) ? record.sequence : 0;
+    if (sequence != last_sequence || last_display_state != current_state)
+    {
+      if (sequence != 0)
+      {
+        oled_printf(0, 0, "%02d:%02d:%02d      ",
+                    record.rtc_time.Hours,
+                    record.rtc_time.Minutes,
+                    record.rtc_time.Seconds);
+        oled_printf(0, 1, "%.2f V  ", record.voltage[0]);
+      }
+      else
+      {
+        oled_printf(0, 0, "--:--:--      ");
+        oled_printf(0, 1, "-.-- V  ");
+      }
+      last_sequence = sequence;
+    }
+    oled_printf(0, 2, data_storage_busy() ? "SD busy " : "        ");
 
     if (last_display_state != current_state)
     {
-      oled_printf(0, 2, "        ");
       oled_printf(0, 3, "        ");
     }
   }
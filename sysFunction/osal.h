@@ -0,0 +1,41 @@
+#ifndef __OSAL_H__
+#define __OSAL_H__
+
+#include "stdint.h"
+
+// 操作系统抽象层：线程、消息队列、互斥锁与周期延时。
+// 目标板由osal_cmsis.c映射到CMSIS-RTOS2(APP_USE_RTOS=1时与内核一并加入工程)，主机仿真由osal_posix.c映射到pthread。
+
+#define OSAL_WAIT_FOREVER 0xFFFFFFFFu
+
+// 线程优先级，数值越小优先级越高（与scheduler任务表一致）
+#define OSAL_PRIO_MAX 5
+
+typedef enum
+{
+    OSAL_OK = 0,
+    OSAL_ERROR = 1,
+    OSAL_TIMEOUT = 2
+} osal_status_t;
+
+typedef void *osal_thread_t;
+typedef void *osal_queue_t;
+typedef void *osal_mutex_t;
+
+typedef void (*osal_entry_t)(void *arg);
+
+osal_status_t osal_init(void);
+void osal_start(void);
+osal_status_t osal_thread_create(osal_thread_t *thread, const char *name, osal_entry_t entry, void *arg,
+                                 uint32_t stack_bytes, uint8_t priority);
+osal_thread_t osal_thread_self(void);
+osal_status_t osal_queue_create(osal_queue_t *queue, uint32_t depth, uint32_t item_size);
+osal_status_t osal_queue_send(osal_queue_t queue, const void *item, uint32_t timeout_ms);
+osal_status_t osal_queue_recv(osal_queue_t queue, void *item, uint32_t timeout_ms);
+osal_status_t osal_mutex_create(osal_mutex_t *mutex);
+void osal_mutex_lock(osal_mutex_t mutex);
+void osal_mutex_unlock(osal_mutex_t mutex);
+void osal_delay_until(uint32_t *wake_ms, uint32_t period_ms);
+uint32_t osal_now_ms(void);
+
+#endif
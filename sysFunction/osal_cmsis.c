@@ -0,0 +1,126 @@
+#include "app_threads.h"
+
+#if APP_USE_RTOS
+
+#include "cmsis_os2.h"
+
+// CMSIS-RTOS2移植：默认工程不包含本文件与RTOS内核。置APP_USE_RTOS=1时，须将本文件与RTOS内核
+// (如CubeMX生成的FreeRTOS + CMSIS_V2封装)一并加入工程，
+// 并将HAL时基改为TIM，SysTick交由内核使用。内核tick须为1kHz，tick即毫秒。
+// 队列发送在中断中调用时超时须为0。
+
+static const osPriority_t osal_priority_map[OSAL_PRIO_MAX] = {
+    osPriorityRealtime,
+    osPriorityHigh,
+    osPriorityAboveNormal,
+    osPriorityNormal,
+    osPriorityBelowNormal};
+
+// 毫秒转内核超时参数
+static uint32_t osal_ms_to_ticks(uint32_t ms)
+{
+    return ms == OSAL_WAIT_FOREVER ? osWaitForever : ms;
+}
+
+// 初始化内核，须在创建线程前调用
+osal_status_t osal_init(void)
+{
+    return osKernelInitialize() == osOK ? OSAL_OK : OSAL_ERROR;
+}
+
+// 启动内核调度，不返回
+void osal_start(void)
+{
+    osKernelStart();
+    while (1)
+    {
+    }
+}
+
+// 创建线程
+osal_status_t osal_thread_create(osal_thread_t *thread, const char *name, osal_entry_t entry, void *arg,
+                                 uint32_t stack_bytes, uint8_t priority)
+{
+    osThreadAttr_t attr = {0};
+
+    if (priority >= OSAL_PRIO_MAX)
+        return OSAL_ERROR;
+
+    attr.name = name;
+    attr.stack_size = stack_bytes;
+    attr.priority = osal_priority_map[priority];
+
+    *thread = osThreadNew(entry, arg, &attr);
+    return *thread != NULL ? OSAL_OK : OSAL_ERROR;
+}
+
+// 当前线程
+osal_thread_t osal_thread_self(void)
+{
+    return (osal_thread_t)osThreadGetId();
+}
+
+// 创建定长消息队列
+osal_status_t osal_queue_create(osal_queue_t *queue, uint32_t depth, uint32_t item_size)
+{
+    *queue = osMessageQueueNew(depth, item_size, NULL);
+    return *queue != NULL ? OSAL_OK : OSAL_ERROR;
+}
+
+// 发送消息，队列满时最多等待timeout_ms
+osal_status_t osal_queue_send(osal_queue_t queue, const void *item, uint32_t timeout_ms)
+{
+    osStatus_t status = osMessageQueuePut((osMessageQueueId_t)queue, item, 0, osal_ms_to_ticks(timeout_ms));
+
+    if (status == osOK)
+        return OSAL_OK;
+    return (status == osErrorTimeout || status == osErrorResource) ? OSAL_TIMEOUT : OSAL_ERROR;
+}
+
+// 接收消息，队列空时最多等待timeout_ms
+osal_status_t osal_queue_recv(osal_queue_t queue, void *item, uint32_t timeout_ms)
+{
+    osStatus_t status = osMessageQueueGet((osMessageQueueId_t)queue, item, NULL, osal_ms_to_ticks(timeout_ms));
+
+    if (status == osOK)
+        return OSAL_OK;
+    return (status == osErrorTimeout || status == osErrorResource) ? OSAL_TIMEOUT : OSAL_ERROR;
+}
+
+// 创建互斥锁，带优先级继承，低优先级线程持锁时不会长期阻塞高优先级线程
+osal_status_t osal_mutex_create(osal_mutex_t *mutex)
+{
+    osMutexAttr_t attr = {0};
+
+    attr.attr_bits = osMutexPrioInherit | osMutexRecursive;
+    *mutex = osMutexNew(&attr);
+    return *mutex != NULL ? OSAL_OK : OSAL_ERROR;
+}
+
+void osal_mutex_lock(osal_mutex_t mutex)
+{
+    osMutexAcquire((osMutexId_t)mutex, osWaitForever);
+}
+
+void osal_mutex_unlock(osal_mutex_t mutex)
+{
+    osMutexRelease((osMutexId_t)mutex);
+}
+
+// 相位锁定的周期延时：*wake_ms += period_ms 后睡眠到该时刻
+void osal_delay_until(uint32_t *wake_ms, uint32_t period_ms)
+{
+    *wake_ms += period_ms;
+    if ((int32_t)(*wake_ms - osal_now_ms()) > 0)
+    {
+        osDelayUntil(*wake_ms);
+    }
+}
+
+// 当前时刻(ms)
+uint32_t osal_now_ms(void)
+{
+    return osKernelGetTickCount();
+}
+
+#endif
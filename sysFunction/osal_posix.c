@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include "osal.h"
+
+// POSIX移植：主机上用pthread运行同一套应用线程，用于仿真与压力测试，不参与固件编译。
+// 有权限时线程按SCHED_FIFO实时优先级运行，否则退回默认调度策略。
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint32_t depth;
+    uint32_t item_size;
+    uint32_t head;
+    uint32_t count;
+    uint8_t *items;
+} osal_posix_queue_t;
+
+typedef struct
+{
+    osal_entry_t entry;
+    void *arg;
+} osal_posix_start_t;
+
+static struct timespec osal_epoch;
+
+// 计算超时的绝对时刻(CLOCK_MONOTONIC)
+static void osal_deadline(struct timespec *ts, uint32_t timeout_ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout_ms / 1000;
+    ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// 等待条件变量，deadline为NULL时不超时
+static int osal_cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *deadline)
+{
+    if (deadline == NULL)
+        return pthread_cond_wait(cond, lock);
+    return pthread_cond_timedwait(cond, lock, deadline);
+}
+
+static void *osal_thread_trampoline(void *arg)
+{
+    osal_posix_start_t start = *(osal_posix_start_t *)arg;
+
+    free(arg);
+    start.entry(start.arg);
+    return NULL;
+}
+
+osal_status_t osal_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &osal_epoch);
+    return OSAL_OK;
+}
+
+// 线程在创建时即开始运行，主线程在此挂起
+void osal_start(void)
+{
+    while (1)
+    {
+        pause();
+    }
+}
+
+osal_status_t osal_thread_create(osal_thread_t *thread, const char *name, osal_entry_t entry, void *arg,
+                                 uint32_t stack_bytes, uint8_t priority)
+{
+    pthread_t tid;
+    pthread_attr_t attr;
+    struct sched_param param;
+    osal_posix_start_t *start;
+    int err;
+
+    (void)stack_bytes;
+    if (priority >= OSAL_PRIO_MAX)
+        return OSAL_ERROR;
+
+    start = malloc(sizeof(*start));
+    if (start == NULL)
+        return OSAL_ERROR;
+    start->entry = entry;
+    start->arg = arg;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + (OSAL_PRIO_MAX - priority);
+    pthread_attr_setschedparam(&attr, &param);
+
+    err = pthread_create(&tid, &attr, osal_thread_trampoline, start);
+    if (err == EPERM)
+    {
+        err = pthread_create(&tid, NULL, osal_thread_trampoline, start);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (err != 0)
+    {
+        free(start);
+        return OSAL_ERROR;
+    }
+
+#ifdef __linux__
+    pthread_setname_np(tid, name);
+#else
+    (void)name;
+#endif
+    pthread_detach(tid);
+    *thread = (osal_thread_t)(uintptr_t)tid;
+    return OSAL_OK;
+}
+
+osal_thread_t osal_thread_self(void)
+{
+    return (osal_thread_t)(uintptr_t)pthread_self();
+}
+
+osal_status_t osal_queue_create(osal_queue_t *queue, uint32_t depth, uint32_t item_size)
+{
+    osal_posix_queue_t *q = calloc(1, sizeof(*q));
+    pthread_condattr_t cattr;
+
+    if (q == NULL)
+        return OSAL_ERROR;
+    q->items = malloc((size_t)depth * item_size);
+    if (q->items == NULL)
+    {
+        free(q);
+        return OSAL_ERROR;
+    }
+    q->depth = depth;
+    q->item_size = item_size;
+
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&q->not_empty, &cattr);
+    pthread_cond_init(&q->not_full, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    *queue = q;
+    return OSAL_OK;
+}
+
+osal_status_t osal_queue_send(osal_queue_t queue, const void *item, uint32_t timeout_ms)
+{
+    osal_posix_queue_t *q = queue;
+    struct timespec deadline;
+    osal_status_t status = OSAL_OK;
+
+    if (timeout_ms != OSAL_WAIT_FOREVER)
+        osal_deadline(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->depth)
+    {
+        if (timeout_ms == 0 ||
+            osal_cond_wait(&q->not_full, &q->lock, timeout_ms == OSAL_WAIT_FOREVER ? NULL : &deadline) == ETIMEDOUT)
+        {
+            status = OSAL_TIMEOUT;
+            break;
+        }
+    }
+    if (status == OSAL_OK)
+    {
+        memcpy(q->items + ((q->head + q->count) % q->depth) * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return status;
+}
+
+osal_status_t osal_queue_recv(osal_queue_t queue, void *item, uint32_t timeout_ms)
+{
+    osal_posix_queue_t *q = queue;
+    struct timespec deadline;
+    osal_status_t status = OSAL_OK;
+
+    if (timeout_ms != OSAL_WAIT_FOREVER)
+        osal_deadline(&deadline, timeout_ms);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0)
+    {
+        if (timeout_ms == 0 ||
+            osal_cond_wait(&q->not_empty, &q->lock, timeout_ms == OSAL_WAIT_FOREVER ? NULL : &deadline) == ETIMEDOUT)
+        {
+            status = OSAL_TIMEOUT;
+            break;
+        }
+    }
+    if (status == OSAL_OK)
+    {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->depth;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return status;
+}
+
+// 递归互斥锁，带优先级继承
+osal_status_t osal_mutex_create(osal_mutex_t *mutex)
+{
+    pthread_mutex_t *m = malloc(sizeof(*m));
+    pthread_mutexattr_t attr;
+
+    if (m == NULL)
+        return OSAL_ERROR;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    *mutex = m;
+    return OSAL_OK;
+}
+
+void osal_mutex_lock(osal_mutex_t mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t *)mutex);
+}
+
+void osal_mutex_unlock(osal_mutex_t mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+void osal_delay_until(uint32_t *wake_ms, uint32_t period_ms)
+{
+    int32_t remain;
+    struct timespec ts;
+
+    *wake_ms += period_ms;
+    remain = (int32_t)(*wake_ms - osal_now_ms());
+    if (remain > 0)
+    {
+        ts.tv_sec = remain / 1000;
+        ts.tv_nsec = (long)(remain % 1000) * 1000000L;
+        while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+        {
+        }
+    }
+}
+
+uint32_t osal_now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ns = (int64_t)(now.tv_sec - osal_epoch.tv_sec) * 1000000000LL + (now.tv_nsec - osal_epoch.tv_nsec);
+
+    return (uint32_t)(ns / 1000000LL);
+}
@@ -0,0 +1,58 @@
+#include "periodic_timer.h"
+
+// 相位锁定的周期定时：到期后 next += period，而不是 next = now + period，
+// 任务自身的执行延迟不会累积成周期漂移。时间比较均取有符号差，32位tick回绕后仍正确。
+
+// 启动定时器，首次在now+period到期；周期为0返回0，定时器不变
+uint8_t periodic_timer_start(periodic_timer_t *timer, uint32_t period, periodic_policy_t policy, uint32_t now)
+{
+    if (period == 0)
+    {
+        return 0;
+    }
+
+    timer->period = period;
+    timer->policy = policy;
+    timer->next = now + period;
+    timer->skipped = 0;
+    return 1;
+}
+
+// 检查是否到期，到期返回1并推进到下一个周期；未启动(周期为0)的定时器不会到期
+uint8_t periodic_timer_expired(periodic_timer_t *timer, uint32_t now)
+{
+    if (timer->period == 0 || (int32_t)(now - timer->next) < 0)
+    {
+        return 0;
+    }
+
+    timer->next += timer->period;
+
+    if (timer->policy == PERIODIC_SKIP && (int32_t)(now - timer->next) >= 0)
+    {
+        uint32_t missed = (now - timer->next) / timer->period + 1;
+        timer->next += missed * timer->period;
+        timer->skipped += missed;
+    }
+
+    return 1;
+}
+
+// 修改周期，以上一次到期时刻为基准重新计算下次到期，保持相位；周期为0返回0，定时器不变
+uint8_t periodic_timer_set_period(periodic_timer_t *timer, uint32_t period)
+{
+    if (period == 0)
+    {
+        return 0;
+    }
+
+    timer->next = timer->next - timer->period + period;
+    timer->period = period;
+    return 1;
+}
+
+// 相对到期时刻的延迟(ms)，未到期为负
+int32_t periodic_timer_lateness(const periodic_timer_t *timer, uint32_t now)
+{
+    return (int32_t)(now - timer->next);
+}
@@ -0,0 +1,25 @@
+#ifndef __PERIODIC_TIMER_H__
+#define __PERIODIC_TIMER_H__
+
+#include "stdint.h"
+
+typedef enum
+{
+    PERIODIC_CATCH_UP = 0, // 落后多个周期时逐次补发，到期次数不丢
+    PERIODIC_SKIP = 1      // 落后时跳过错过的周期，只触发一次，保持原相位
+} periodic_policy_t;
+
+typedef struct
+{
+    uint32_t next;            // 下次到期时刻(ms)
+    uint32_t period;          // 周期(ms)
+    periodic_policy_t policy; 
+    uint32_t skipped;         // SKIP策略下累计跳过的周期数
+} periodic_timer_t;
+
+uint8_t periodic_timer_start(periodic_timer_t *timer, uint32_t period, periodic_policy_t policy, uint32_t now); 
+uint8_t periodic_timer_expired(periodic_timer_t *timer, uint32_t now);                                          
+uint8_t periodic_timer_set_period(periodic_timer_t *timer, uint32_t period);                                    
+int32_t periodic_timer_lateness(const periodic_timer_t *timer, uint32_t now);                                   
+
+#endif
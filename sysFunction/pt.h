@@ -0,0 +1,57 @@
+#ifndef __PT_H__
+#define __PT_H__
+
+#include "stdint.h"
+
+// 无栈协程（protothread）：用switch/__LINE__保存续点，局部变量不跨越让出点保存，
+// 需要跨让出点的状态放在static或上下文结构中。同一函数内每行最多一个让出点。
+
+typedef struct
+{
+    uint16_t lc; // 续点行号，0为起始
+} pt_t;
+
+#define PT_WAITING 0 // 等待条件，下次调度继续
+#define PT_YIELDED 1 // 主动让出
+#define PT_EXITED 2  // 中途退出
+#define PT_ENDED 3   // 运行结束
+
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+#define PT_BEGIN(pt) \
+    switch ((pt)->lc) \
+    {                 \
+    case 0:
+
+#define PT_END(pt) \
+    }              \
+    (pt)->lc = 0;  \
+    return PT_ENDED
+
+#define PT_WAIT_UNTIL(pt, cond) \
+    do                          \
+    {                           \
+        (pt)->lc = __LINE__;    \
+    case __LINE__:              \
+        if (!(cond))            \
+            return PT_WAITING;  \
+    } while (0)
+
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL((pt), !(cond))
+
+#define PT_YIELD(pt)                 \
+    do                               \
+    {                                \
+        (pt)->lc = __LINE__;         \
+        return PT_YIELDED;           \
+    case __LINE__:;                  \
+    } while (0)
+
+#define PT_EXIT(pt)       \
+    do                    \
+    {                     \
+        (pt)->lc = 0;     \
+        return PT_EXITED; \
+    } while (0)
+
+#endif
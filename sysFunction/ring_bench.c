@@ -0,0 +1,200 @@
+#include "ring_bench.h"
+#include "ringbuffer.h"
+#include "spsc_ring.h"
+
+// 环形缓冲测试：吞吐对比与中断生产者压力测试
+// 吞吐：同一数据量分块经rt_ringbuffer拷入拷出、spsc_ring拷入拷出、spsc_ring原地消费三种方式传输
+// 压力：TIM14中断按20kHz写入不定长的递增字节流，主循环用acquire/release原地校验
+
+#define RING_BENCH_POOL 1024
+#define RING_BENCH_BYTES 32768
+#define RING_BENCH_CHUNK 48
+#define RING_STRESS_POOL 256
+#define RING_STRESS_RATE_HZ 20000
+#define RING_STRESS_MS 1000
+
+extern TIM_HandleTypeDef htim14;
+
+static uint8_t ring_pool[RING_BENCH_POOL];
+static uint8_t ring_src[RING_BENCH_CHUNK];
+static uint8_t ring_dst[RING_BENCH_CHUNK];
+
+static spsc_ring_t ring_stress;
+static __IO uint8_t ring_stress_running = 0;
+static uint8_t ring_stress_next = 0;      // 中断侧下一个写入字节
+static uint32_t ring_stress_seed = 1;
+static __IO uint32_t ring_stress_produced = 0;
+static __IO uint32_t ring_stress_full = 0; // 缓冲区满未能写入的次数
+
+// 数据块校验和，防止编译器把原地消费优化掉
+static uint32_t ring_bench_sum(const uint8_t *data, uint32_t length)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < length; i++)
+        sum += data[i];
+    return sum;
+}
+
+static uint32_t ring_bench_rt(void)
+{
+    struct rt_ringbuffer rb;
+    uint32_t start;
+
+    rt_ringbuffer_init(&rb, ring_pool, RING_BENCH_POOL);
+    start = DWT->CYCCNT;
+    for (uint32_t done = 0; done < RING_BENCH_BYTES; done += RING_BENCH_CHUNK)
+    {
+        rt_ringbuffer_put(&rb, ring_src, RING_BENCH_CHUNK);
+        rt_ringbuffer_get(&rb, ring_dst, RING_BENCH_CHUNK);
+    }
+    return DWT->CYCCNT - start;
+}
+
+static uint32_t ring_bench_spsc_copy(void)
+{
+    spsc_ring_t ring;
+    uint32_t start;
+
+    spsc_ring_init(&ring, ring_pool, RING_BENCH_POOL);
+    start = DWT->CYCCNT;
+    for (uint32_t done = 0; done < RING_BENCH_BYTES; done += RING_BENCH_CHUNK)
+    {
+        spsc_ring_write(&ring, ring_src, RING_BENCH_CHUNK);
+        spsc_ring_read(&ring, ring_dst, RING_BENCH_CHUNK);
+    }
+    return DWT->CYCCNT - start;
+}
+
+// 拷入后在环内直接计算校验和，不再拷出
+static uint32_t ring_bench_spsc_span(uint32_t *sum)
+{
+    spsc_ring_t ring;
+    uint8_t *span;
+    uint32_t start;
+
+    spsc_ring_init(&ring, ring_pool, RING_BENCH_POOL);
+    *sum = 0;
+    start = DWT->CYCCNT;
+    for (uint32_t done = 0; done < RING_BENCH_BYTES; done += RING_BENCH_CHUNK)
+    {
+        spsc_ring_write(&ring, ring_src, RING_BENCH_CHUNK);
+        uint32_t length;
+        while ((length = spsc_ring_acquire(&ring, &span)) > 0)
+        {
+            *sum += ring_bench_sum(span, length);
+            spsc_ring_release(&ring, length);
+        }
+    }
+    return DWT->CYCCNT - start;
+}
+
+// 压力测试生产者：TIM14更新中断，由tim.c的HAL_TIM_PeriodElapsedCallback分发
+void ring_bench_timer_isr(void)
+{
+    if (!ring_stress_running)
+        return;
+
+    uint8_t data[16];
+    ring_stress_seed = ring_stress_seed * 1103515245u + 12345u;
+    uint32_t length = ((ring_stress_seed >> 16) & 0x0F) + 1;
+
+    for (uint32_t i = 0; i < length; i++)
+        data[i] = (uint8_t)(ring_stress_next + i);
+
+    uint32_t written = spsc_ring_write(&ring_stress, data, length);
+    ring_stress_next += (uint8_t)written;
+    ring_stress_produced += written;
+    if (written < length)
+        ring_stress_full++;
+}
+
+// TIM14按指定频率产生更新中断
+static void ring_stress_timer_start(uint32_t rate_hz)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    uint32_t clock = ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_HCLK_DIV1) ? pclk1 : pclk1 * 2;
+    uint32_t ticks = clock / rate_hz;
+    uint32_t psc = (ticks - 1) / 65536 + 1;
+
+    __HAL_TIM_SET_PRESCALER(&htim14, psc - 1);
+    __HAL_TIM_SET_AUTORELOAD(&htim14, ticks / psc - 1);
+    __HAL_TIM_SET_COUNTER(&htim14, 0);
+    htim14.Instance->EGR = TIM_EGR_UG;
+    __HAL_TIM_CLEAR_FLAG(&htim14, TIM_FLAG_UPDATE);
+    HAL_TIM_Base_Start_IT(&htim14);
+}
+
+// 中断生产者/主循环消费者压力测试，返回校验错误字节数
+static uint32_t ring_stress_run(uint32_t *consumed)
+{
+    static uint8_t pool[RING_STRESS_POOL];
+    uint8_t expect = 0;
+    uint32_t errors = 0;
+    uint8_t *span;
+
+    spsc_ring_init(&ring_stress, pool, sizeof(pool));
+    ring_stress_next = 0;
+    ring_stress_produced = 0;
+    ring_stress_full = 0;
+    *consumed = 0;
+
+    ring_stress_running = 1;
+    ring_stress_timer_start(RING_STRESS_RATE_HZ);
+
+    uint32_t start = HAL_GetTick();
+    while (ring_stress_running)
+    {
+        if (HAL_GetTick() - start >= RING_STRESS_MS)
+        {
+            HAL_TIM_Base_Stop_IT(&htim14);
+            ring_stress_running = 0;
+        }
+
+        uint32_t length;
+        while ((length = spsc_ring_acquire(&ring_stress, &span)) > 0)
+        {
+            for (uint32_t i = 0; i < length; i++)
+            {
+                if (span[i] != expect)
+                {
+                    errors++;
+                    expect = span[i];
+                }
+                expect++;
+            }
+            *consumed += length;
+            spsc_ring_release(&ring_stress, length);
+        }
+    }
+
+    return errors;
+}
+
+// 运行吞吐对比与压力测试，结果输出到串口
+void ring_bench_run(void)
+{
+    uint32_t sum;
+    uint32_t consumed;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < RING_BENCH_CHUNK; i++)
+        ring_src[i] = (uint8_t)i;
+
+    uint32_t rt_cycles = ring_bench_rt();
+    uint32_t copy_cycles = ring_bench_spsc_copy();
+    uint32_t span_cycles = ring_bench_spsc_span(&sum);
+
+    my_printf(&huart1, "ring bench: %d bytes in %d-byte chunks\r\n", RING_BENCH_BYTES, RING_BENCH_CHUNK);
+    my_printf(&huart1, "rt_ringbuffer put/get: %.2f cycles/byte\r\n", (float)rt_cycles / RING_BENCH_BYTES);
+    my_printf(&huart1, "spsc write/read:       %.2f cycles/byte\r\n", (float)copy_cycles / RING_BENCH_BYTES);
+    my_printf(&huart1, "spsc write/span:       %.2f cycles/byte (checksum %lu)\r\n",
+              (float)span_cycles / RING_BENCH_BYTES, sum);
+
+    uint32_t errors = ring_stress_run(&consumed);
+    my_printf(&huart1, "ring stress: %dHz ISR producer for %dms\r\n", RING_STRESS_RATE_HZ, RING_STRESS_MS);
+    my_printf(&huart1, "produced %lu consumed %lu full %lu errors %lu -> %s\r\n",
+              ring_stress_produced, consumed, ring_stress_full, errors,
+              (errors == 0 && consumed == ring_stress_produced) ? "PASS" : "FAIL");
+}
@@ -0,0 +1,9 @@
+#ifndef __RING_BENCH_H__
+#define __RING_BENCH_H__
+
+#include "mydefine.h"
+
+void ring_bench_run(void);
+void ring_bench_timer_isr(void);
+
+#endif
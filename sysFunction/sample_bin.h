@@ -0,0 +1,61 @@
+#ifndef __SAMPLE_BIN_H__
+#define __SAMPLE_BIN_H__
+
+#include "stdint.h"
+
+// 二进制采样记录文件(bin/sampleData<时间>.bin)，固件与主机解码工具tools/bin2csv共用。
+// 文件以sample_bin_header_t开头，其后为定长记录，全部小端：
+//   偏移 0  uint32 time       Unix秒
+//   偏移 4  uint16 ticks      秒内计数，单位1/tick_hz秒
+//   偏移 6  uint8  overlimit  越限通道掩码
+//   偏移 7  uint8  flags      SAMPLE_BIN_FLAG_*
+//   偏移 8  int32  value[channels]  各通道电压，按value_format编码
+//   之后    uint16 sequence   文件内记录序号，用于发现丢失的记录
+//           uint16 crc16      记录其余字节的CRC-16/CCITT-FALSE
+// 记录长度为record_size，解码时以文件头为准。
+
+#define SAMPLE_BIN_MAGIC 0x4E425343 // "CSBN"
+#define SAMPLE_BIN_VERSION 1
+#define SAMPLE_BIN_FORMAT_Q16 1 // 电压Q16.16定点，单位V
+#define SAMPLE_BIN_TICK_HZ 1000
+
+#define SAMPLE_BIN_FLAG_WAVE 0x01   // 记录时波形分析开启
+#define SAMPLE_BIN_FLAG_HIDDEN 0x02 // 记录时串口为隐藏输出格式
+
+#define SAMPLE_BIN_VALUE_OFFSET 8
+#define SAMPLE_BIN_RECORD_SIZE(channels) (SAMPLE_BIN_VALUE_OFFSET + 4 * (channels) + 4)
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint16_t record_size;
+    uint8_t channels;
+    uint8_t value_format;
+    uint32_t tick_hz;
+    uint32_t start_time;       // 文件创建时刻Unix时间
+    uint32_t boot_count;
+    uint32_t sample_period_ms; // 创建时的采样周期
+    uint16_t reserved;
+    uint16_t crc16;            // 头部其余字节的CRC-16/CCITT-FALSE
+} sample_bin_header_t;
+
+// CRC-16/CCITT-FALSE，多项式0x1021，初值0xFFFF
+static inline uint16_t sample_bin_crc16(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+#endif
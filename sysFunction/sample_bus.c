@@ -0,0 +1,58 @@
+#include "sample_bus.h"
+#include "stddef.h"
+
+static sample_bus_subscriber_t g_subscribers[SAMPLE_BUS_MAX_SUBSCRIBERS];
+static uint8_t g_subscriber_count = 0;
+static sample_record_t g_latest;
+static uint8_t g_latest_valid = 0;
+static uint32_t g_sequence = 0;
+
+// 订阅采样记录，重复订阅忽略，已满返回0
+uint8_t sample_bus_subscribe(sample_bus_subscriber_t subscriber)
+{
+    for (uint8_t i = 0; i < g_subscriber_count; i++)
+    {
+        if (g_subscribers[i] == subscriber)
+        {
+            return 1;
+        }
+    }
+    if (subscriber == NULL || g_subscriber_count >= SAMPLE_BUS_MAX_SUBSCRIBERS)
+    {
+        return 0;
+    }
+
+    g_subscribers[g_subscriber_count++] = subscriber;
+    return 1;
+}
+
+// 发布一条采样记录：编号后保存为最近记录，按订阅顺序交给各订阅者
+void sample_bus_publish(sample_record_t *record)
+{
+    record->sequence = ++g_sequence;
+    g_latest = *record;
+    g_latest_valid = 1;
+
+    for (uint8_t i = 0; i < g_subscriber_count; i++)
+    {
+        g_subscribers[i](&g_latest);
+    }
+}
+
+// 获取最近一条采样记录，尚无记录时返回0
+uint8_t sample_bus_latest(sample_record_t *record)
+{
+    if (!g_latest_valid)
+    {
+        return 0;
+    }
+
+    *record = g_latest;
+    return 1;
+}
+
+// 丢弃最近记录，开始采样时调用，避免显示上一次采样的结果
+void sample_bus_clear(void)
+{
+    g_latest_valid = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __SAMPLE_BUS_H__
+#define __SAMPLE_BUS_H__
+
+#include "main.h"
+#include "adc_channel.h"
+
+// 采样总线：采样任务每个采样周期采集一次，发布一条只读采样记录；
+// 存储与串口输出订阅记录，OLED与LED读取最近一条记录，不再各自换算电压、判断超限。
+// 订阅者在发布者上下文中同步调用(裸机主循环或RTOS下持app_lock的采样线程)
+
+#define SAMPLE_BUS_MAX_SUBSCRIBERS 4
+
+#define SAMPLE_REC_CONFIG_OK 0x01 // 采样时配置有效，limit为各通道限值
+#define SAMPLE_REC_WAVE 0x02      // 采样时波形分析开启
+
+#define SAMPLE_WAVE_STATS 0x01 // rms/peak_to_peak/crest_factor有效
+#define SAMPLE_WAVE_THD 0x02   // thd有效
+
+typedef struct
+{
+    uint8_t valid; // SAMPLE_WAVE_*
+    float rms;
+    float peak_to_peak;
+    float crest_factor;
+    float thd;
+} sample_wave_t;
+
+typedef struct
+{
+    uint32_t sequence;              // 发布序号，从1开始
+    uint32_t tick;                  // 采集时刻HAL_GetTick
+    uint32_t time;                  // 采集时刻Unix秒
+    uint16_t ms;                    // 秒内毫秒
+    uint8_t overlimit_mask;         // 越限通道掩码
+    uint8_t flags;                  // SAMPLE_REC_*
+    RTC_TimeTypeDef rtc_time;
+    RTC_DateTypeDef rtc_date;
+    float voltage[ADC_CHANNEL_COUNT]; // 各通道电压，已乘通道变比
+    float limit[ADC_CHANNEL_COUNT];
+    sample_wave_t wave[ADC_CHANNEL_COUNT]; // 波形分析开启时有效
+} sample_record_t;
+
+typedef void (*sample_bus_subscriber_t)(const sample_record_t *record);
+
+uint8_t sample_bus_subscribe(sample_bus_subscriber_t subscriber);
+void sample_bus_publish(sample_record_t *record);
+uint8_t sample_bus_latest(sample_record_t *record);
+void sample_bus_clear(void);
+
+#endif
@@ -4,6 +4,7 @@
 #include "data_storage.h"
 #include "usart_app.h"
 #include "adc_app.h"
+#include "clock_profile.h"
 
 // 采样控制全局变量
 static sampling_control_t g_sampling_control = {0};
@@ -11,6 +12,8 @@ static uint8_t g_sampling_initialized = 0;
 
 #define LED_BLINK_PERIOD_MS 1000
 
+static void sampling_store_record(const sample_record_t *record);
+
 // 采样初始化
 sampling_status_t sampling_init(void)
 {
@@ -23,9 +26,10 @@ sampling_status_t sampling_init(void)
 
     g_sampling_control.state = SAMPLING_IDLE;
     g_sampling_control.cycle = config_get_sampling_cycle();
-    g_sampling_control.last_sample_time = 0;
-    g_sampling_control.led_blink_time = 0;
+    periodic_timer_start(&g_sampling_control.sample_timer, g_sampling_control.cycle * 1000, PERIODIC_SKIP, 0);
+    periodic_timer_start(&g_sampling_control.led_blink_timer, LED_BLINK_PERIOD_MS, PERIODIC_SKIP, 0);
     g_sampling_control.led_blink_state = 0;
+    sample_bus_subscribe(sampling_store_record);
 
     g_sampling_initialized = 1;
     return SAMPLING_OK;
@@ -38,9 +42,11 @@ sampling_status_t sampling_start(void)
         return SAMPLING_ERROR;
 
     g_sampling_control.state = SAMPLING_ACTIVE;
-    g_sampling_control.last_sample_time = HAL_GetTick();
-    g_sampling_control.led_blink_time = HAL_GetTick();
+    uint32_t now = HAL_GetTick();
+    periodic_timer_start(&g_sampling_control.sample_timer, g_sampling_control.cycle * 1000, PERIODIC_SKIP, now);
+    periodic_timer_start(&g_sampling_control.led_blink_timer, LED_BLINK_PERIOD_MS, PERIODIC_SKIP, now);
     g_sampling_control.led_blink_state = 0;
+    sample_bus_clear();
 
     return SAMPLING_OK;
 }
@@ -51,6 +57,9 @@ sampling_status_t sampling_stop(void)
     if (!g_sampling_initialized)
         return SAMPLING_ERROR;
 
+    // 已冻结的突发记录交由存储任务写完后再撤销触发
+    adc_trigger_cancel();
+
     g_sampling_control.state = SAMPLING_IDLE;
     g_sampling_control.led_blink_state = 0;
 
@@ -69,6 +78,7 @@ sampling_status_t sampling_set_cycle(sampling_cycle_t cycle)
     }
 
     g_sampling_control.cycle = cycle;
+    periodic_timer_set_period(&g_sampling_control.sample_timer, cycle * 1000);
 
     if (config_set_sampling_cycle(cycle) == CONFIG_OK)
     {
@@ -94,7 +104,7 @@ sampling_cycle_t sampling_get_cycle(void)
     return g_sampling_control.cycle;
 }
 
-// 判断是否到采样时间
+// 判断是否到采样时间，到期即推进到下一周期（相位锁定，错过的周期跳过）
 uint8_t sampling_should_sample(void)
 {
     if (!g_sampling_initialized || g_sampling_control.state != SAMPLING_ACTIVE)
@@ -102,11 +112,7 @@ uint8_t sampling_should_sample(void)
         return 0;
     }
 
-    uint32_t current_time = HAL_GetTick();
-    uint32_t elapsed_time = current_time - g_sampling_control.last_sample_time;
-    uint32_t cycle_ms = g_sampling_control.cycle * 1000;
-
-    return (elapsed_time >= cycle_ms) ? 1 : 0;
+    return periodic_timer_expired(&g_sampling_control.sample_timer, HAL_GetTick());
 }
 
 // 更新LED闪烁状态
@@ -118,43 +124,247 @@ void sampling_update_led_blink(void)
         return;
     }
 
-    uint32_t current_time = HAL_GetTick();
-    uint32_t elapsed_time = current_time - g_sampling_control.led_blink_time;
-
-    if (elapsed_time >= LED_BLINK_PERIOD_MS)
+    if (periodic_timer_expired(&g_sampling_control.led_blink_timer, HAL_GetTick()))
     {
         g_sampling_control.led_blink_state ^= 1;
-        g_sampling_control.led_blink_time = current_time;
     }
 }
 
-// 获取采样电压
-float sampling_get_voltage(void)
+// 获取通道采样电压（已乘通道变比）
+float sampling_get_channel_voltage(uint8_t channel)
+{
+    config_params_t config_params;
+
+    if (channel >= ADC_CHANNEL_COUNT)
+    {
+        return 0.0f;
+    }
+
+    float raw = adc_get_voltage(channel);
+    if (config_get_params(&config_params) != CONFIG_OK)
+    {
+        return raw;
+    }
+
+    return raw * config_params.ratio[channel];
+}
+
+// 获取全部通道采样电压
+void sampling_get_voltages(float *voltages)
+{
+    config_params_t config_params;
+    uint8_t config_ok = (config_get_params(&config_params) == CONFIG_OK);
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float raw = adc_get_voltage(ch);
+        voltages[ch] = config_ok ? raw * config_params.ratio[ch] : raw;
+    }
+}
+
+// 获取通道波形参数（电压类参数已乘通道变比）
+uint8_t sampling_get_wave_stats(uint8_t channel, adc_wave_stats_t *wave)
+{
+    config_params_t config_params;
+
+    if (!adc_get_wave_stats(channel, wave))
+    {
+        return 0;
+    }
+    if (config_get_params(&config_params) != CONFIG_OK)
+    {
+        return 1;
+    }
+
+    float ratio = config_params.ratio[channel];
+    wave->mean *= ratio;
+    wave->rms *= ratio;
+    wave->std_dev *= ratio;
+    wave->min *= ratio;
+    wave->max *= ratio;
+    wave->peak_to_peak *= ratio;
+
+    return 1;
+}
+
+// 获取通道谐波分析结果（幅值已乘通道变比）
+uint8_t sampling_get_harmonics(uint8_t channel, adc_harmonic_result_t *result)
 {
-    extern __IO float voltage;
     config_params_t config_params;
 
+    if (!adc_get_harmonics(channel, result))
+    {
+        return 0;
+    }
     if (config_get_params(&config_params) != CONFIG_OK)
     {
-        return voltage;
+        return 1;
+    }
+
+    for (uint8_t h = 0; h < result->count; h++)
+    {
+        result->amp[h] *= config_params.ratio[channel];
+    }
+
+    return 1;
+}
+
+// 通道频谱分析（幅值类结果已乘通道变比），不中断采集
+uint8_t sampling_get_spectrum(uint8_t channel, adc_spectrum_result_t *result)
+{
+    config_params_t config_params;
+    clock_profile_t profile = clock_profile_get();
+    uint8_t captured;
+
+    // 自动选档时FFT期间临时满速运行
+    if (clock_profile_get_auto())
+        clock_profile_set(CLOCK_PROFILE_HIGH);
+    captured = adc_spectrum_capture(channel, result);
+    if (clock_profile_get_auto())
+        clock_profile_set(profile);
+
+    if (!captured)
+    {
+        return 0;
+    }
+    if (config_get_params(&config_params) != CONFIG_OK)
+    {
+        return 1;
+    }
+
+    float ratio = config_params.ratio[channel];
+    result->dc *= ratio;
+    result->total_rms *= ratio;
+    for (uint8_t i = 0; i < ADC_SPECTRUM_PEAKS; i++)
+    {
+        result->peak_amp[i] *= ratio;
     }
 
-    return voltage * config_params.ratio;
+    return 1;
 }
 
-// 检查是否超限
-uint8_t sampling_check_overlimit(void)
+// 按通道检查超限，返回超限通道位掩码
+// 开启波形分析时按块内峰值判断，避免交流信号的瞬时超限被均值掩盖
+uint8_t sampling_check_overlimit_mask(const float *voltages)
 {
     config_params_t config_params;
+    adc_wave_stats_t wave;
+    uint8_t mask = 0;
 
     if (config_get_params(&config_params) != CONFIG_OK)
     {
         return 0;
     }
 
-    float current_voltage = sampling_get_voltage();
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float value = voltages[ch];
+        if (wave_analysis_flag && adc_get_wave_stats(ch, &wave))
+        {
+            value = wave.max * config_params.ratio[ch];
+        }
+        if (value > config_params.limit[ch])
+        {
+            mask |= (1 << ch);
+        }
+    }
+
+    return mask;
+}
+
+// 采集一条采样记录：时间戳、各通道电压与限值、超限掩码，波形分析开启时含波形参数。
+// 电压与超限掩码分别取自sampling_get_voltages与sampling_check_overlimit_mask，与单独查询的结果一致
+void sampling_capture(sample_record_t *record)
+{
+    config_params_t config_params;
+    uint8_t config_ok = (config_get_params(&config_params) == CONFIG_OK);
+
+    memset(record, 0, sizeof(*record));
+    record->tick = HAL_GetTick();
+    HAL_RTC_GetTime(&hrtc, &record->rtc_time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &record->rtc_date, RTC_FORMAT_BIN);
+    record->time = convert_rtc_to_unix_timestamp(&record->rtc_time, &record->rtc_date);
+    record->ms = (uint16_t)((record->rtc_time.SecondFraction - record->rtc_time.SubSeconds) * 1000 /
+                            (record->rtc_time.SecondFraction + 1));
+    if (config_ok)
+    {
+        record->flags |= SAMPLE_REC_CONFIG_OK;
+        memcpy(record->limit, config_params.limit, sizeof(record->limit));
+    }
+    if (wave_analysis_flag)
+    {
+        record->flags |= SAMPLE_REC_WAVE;
+    }
+
+    sampling_get_voltages(record->voltage);
+    record->overlimit_mask = sampling_check_overlimit_mask(record->voltage);
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT && wave_analysis_flag; ch++)
+    {
+        float ratio = config_ok ? config_params.ratio[ch] : 1.0f;
+        adc_wave_stats_t wave;
+        adc_harmonic_result_t harmonics;
+        sample_wave_t *out = &record->wave[ch];
+
+        if (adc_get_wave_stats(ch, &wave))
+        {
+            out->valid |= SAMPLE_WAVE_STATS;
+            out->rms = wave.rms * ratio;
+            out->peak_to_peak = wave.peak_to_peak * ratio;
+            out->crest_factor = wave.crest_factor;
+        }
+        if (adc_get_harmonics(ch, &harmonics))
+        {
+            out->valid |= SAMPLE_WAVE_THD;
+            out->thd = harmonics.thd;
+        }
+    }
+}
+
+// 按通道限值刷新预触发门限（换算为ADC码值），限值超出量程的通道不参与触发
+static void sampling_update_trigger(void)
+{
+    config_params_t config_params;
+    uint16_t levels[ADC_CHANNEL_COUNT];
+
+    if (!adc_trigger_is_enabled() || config_get_params(&config_params) != CONFIG_OK)
+    {
+        return;
+    }
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        float ratio = config_params.ratio[ch];
+        float code = (ratio > 0.0f) ? config_params.limit[ch] / ratio / ADC_CODE_TO_VOLT : 4096.0f;
+        levels[ch] = (code < 4096.0f) ? (uint16_t)code + 1 : ADC_TRIGGER_LEVEL_OFF;
+    }
 
-    return (current_voltage > config_params.limit) ? 1 : 0;
+    adc_trigger_arm(levels);
+}
+
+// 自动选择时钟档位：突发记录布防/写出期间满速，15s周期的普通记录在低速档能承受当前采样率时降频，
+// 其余为默认档位
+static void sampling_update_clock_profile(void)
+{
+    clock_profile_t profile = CLOCK_PROFILE_NORMAL;
+
+    if (!clock_profile_get_auto())
+        return;
+
+    if (adc_trigger_get_state() != ADC_TRIGGER_DISARMED)
+    {
+        profile = CLOCK_PROFILE_HIGH;
+    }
+    else if (g_sampling_control.state == SAMPLING_ACTIVE && g_sampling_control.cycle == CYCLE_15S &&
+             !wave_analysis_flag && clock_profile_fits_rate(CLOCK_PROFILE_LOW, adc_get_requested_rate()))
+    {
+        profile = CLOCK_PROFILE_LOW;
+    }
+
+    if (profile != clock_profile_get())
+    {
+        clock_profile_set(profile);
+    }
 }
 
 // 采样任务
@@ -166,16 +376,18 @@ void sampling_task(void)
     sampling_update_led_blink();
     if (g_sampling_control.state == SAMPLING_ACTIVE)
     {
+        sampling_update_trigger();
+
+        // 每个采样周期采集一次，经采样总线交给存储、串口输出与界面
         if (sampling_should_sample())
         {
-            g_sampling_control.last_sample_time = HAL_GetTick();
-
-            float current_voltage = sampling_get_voltage();
-            uint8_t is_overlimit = sampling_check_overlimit();
-
-            sampling_handle_data_storage(current_voltage, is_overlimit);
+            sample_record_t record;
+            sampling_capture(&record);
+            sample_bus_publish(&record);
         }
     }
+
+    sampling_update_clock_profile();
 }
 
 // 获取LED闪烁状态
@@ -186,31 +398,29 @@ uint8_t sampling_get_led_blink_state(void)
     return g_sampling_control.led_blink_state;
 }
 
-// 采样数据存储处理
-void sampling_handle_data_storage(float voltage, uint8_t is_overlimit)
+// 采样总线订阅者：按存储格式写入采样记录，越限通道另写越限记录
+static void sampling_store_record(const sample_record_t *record)
 {
-
     extern output_format_t g_output_format;
 
-    if (g_output_format == OUTPUT_FORMAT_HIDDEN)
+    if (data_storage_get_binary())
     {
-
-        data_storage_status_t result = data_storage_write_hidedata(voltage, is_overlimit);
+        data_storage_write_binary(record);
+    }
+    else if (g_output_format == OUTPUT_FORMAT_HIDDEN)
+    {
+        data_storage_write_hidedata(record);
     }
     else
     {
-
-        data_storage_status_t result = data_storage_write_sample(voltage);
+        data_storage_write_sample(record);
     }
 
-    if (is_overlimit)
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
     {
-        config_params_t config_params;
-        float limit_value = 0.0f;
-
+        if (record->overlimit_mask & (1 << ch))
         {
-            limit_value = config_params.limit;
+            data_storage_write_overlimit(ch, record->voltage[ch], record->limit[ch]);
         }
-        data_storage_status_t result = data_storage_write_overlimit(voltage, limit_value);
     }
 }
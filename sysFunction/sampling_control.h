@@ -2,6 +2,11 @@
 #define __SAMPLING_CONTROL_H__
 
 #include "stdint.h" 
+#include "adc_reduce.h"
+#include "adc_spectrum.h"
+#include "adc_harmonic.h"
+#include "periodic_timer.h"
+#include "sample_bus.h"
 
 
 typedef enum
@@ -23,8 +28,8 @@ typedef struct
 {
     sampling_state_t state;    
     sampling_cycle_t cycle;    
-    uint32_t last_sample_time; 
-    uint32_t led_blink_time;   
+    periodic_timer_t sample_timer;    
+    periodic_timer_t led_blink_timer; 
     uint8_t led_blink_state;  
 } sampling_control_t;
 
@@ -46,11 +51,15 @@ sampling_state_t sampling_get_state(void);
 sampling_cycle_t sampling_get_cycle(void);                  
 void sampling_task(void);                                    
 
-float sampling_get_voltage(void);          
-uint8_t sampling_check_overlimit(void);     
+float sampling_get_channel_voltage(uint8_t channel);
+void sampling_get_voltages(float *voltages);
+uint8_t sampling_get_wave_stats(uint8_t channel, adc_wave_stats_t *wave);
+uint8_t sampling_get_spectrum(uint8_t channel, adc_spectrum_result_t *result);
+uint8_t sampling_get_harmonics(uint8_t channel, adc_harmonic_result_t *result);
+uint8_t sampling_check_overlimit_mask(const float *voltages);
+void sampling_capture(sample_record_t *record);
 uint8_t sampling_should_sample(void);      
 void sampling_update_led_blink(void);       
 uint8_t sampling_get_led_blink_state(void); 
-void sampling_handle_data_storage(float voltage, uint8_t is_overlimit);
 
 #endif 
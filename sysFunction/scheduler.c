@@ -1,37 +1,318 @@
 #include "scheduler.h"
-uint8_t task_num; 
-typedef struct 
+uint8_t task_num;
+typedef struct
 {
-    void (*task_func)(void); 
-    uint32_t rate_ms;        
-    uint32_t last_run;      
+    void (*task_func)(void);
+    uint32_t rate_ms;
+    uint32_t last_run;
+    uint8_t priority;        // 数值越小优先级越高，同时到期时先运行
+    periodic_timer_t timer;  // 相位锁定的到期时刻，落后时跳过错过的周期
+    const char *name;
 } task_t;
 
+typedef struct
+{
+    uint32_t runs;
+    uint64_t total_cycles;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t deadline_miss;  // 启动时已晚于到期时刻一个周期以上的次数
+    uint32_t max_jitter_cycles; // 最大启动延迟(相对到期节拍边界的DWT周期数)
+} task_stats_t;
+
 static task_t scheduler_task[] =
     {
-        {led_task, 1, 0},   
-        {adc_task, 100, 0}, 
-        {key_proc, 5, 0},
-        {uart_task, 5, 0},     
-        {oled_task, 1, 0},     
-        {sampling_task, 10, 0} 
+        {led_task, 10, 0, 3, {0}, "led"},
+        {adc_task, 100, 0, 2, {0}, "adc"},
+        {key_proc, 5, 0, 1, {0}, "key"},
+        {uart_task, 5, 0, 0, {0}, "uart"},
+        {oled_task, 100, 0, 3, {0}, "oled"},
+        {sampling_task, 10, 0, 1, {0}, "sampling"},
+        {config_task, 5, 0, 2, {0}, "config"},
+        {data_storage_task, 5, 0, 3, {0}, "storage"}
 };
 
-void scheduler_init(void) 
+#define TASK_MAX (sizeof(scheduler_task) / sizeof(task_t))
+#define IDLE_WINDOW_MS 1000 // 空闲率统计窗口
+#define TICKLESS_MIN_MS 3    // 距最近到期不足该值时仍按1ms节拍休眠；任务表中有周期不超过该值的任务时停节拍休眠不会发生
+
+// 按到期时刻升序排列的任务索引，表头为最早到期的任务
+static uint8_t task_order[TASK_MAX];
+static task_stats_t task_stats[TASK_MAX];
+
+static uint32_t idle_cycles = 0;        // 当前窗口内WFI休眠周期数
+static uint32_t idle_window_start = 0;  // 当前窗口起始DWT计数
+static uint32_t idle_window_tick = 0;
+static uint8_t idle_percent = 0;        // 上一完整窗口的空闲率
+static uint32_t max_loop_cycles = 0;    // 单次任务运行的最长时间，即主循环最坏响应延迟
+
+static uint8_t tickless_enabled = 1;
+static uint32_t tickless_sleeps = 0;       // 停节拍休眠次数
+static uint32_t tickless_early_wakes = 0;  // 被外设中断提前唤醒的次数
+static uint64_t tickless_sleep_cycles = 0; // 停节拍休眠累计周期数
+static uint32_t tickless_latency_last = 0; // 定时唤醒到恢复运行的周期数
+static uint32_t tickless_latency_max = 0;
+static __IO uint32_t tick_edge_cycles = 0; // 最近一个节拍边界的DWT计数
+
+// 到期判断，按有符号差比较，tick回绕后仍正确
+static uint8_t task_due(uint32_t now, uint8_t id)
+{
+    return periodic_timer_lateness(&scheduler_task[id].timer, now) >= 0;
+}
+
+// 将task_order[pos]处的任务按到期时刻向后插入到正确位置
+static void task_reorder(uint8_t pos)
+{
+    uint8_t id = task_order[pos];
+
+    while (pos + 1 < task_num &&
+           (int32_t)(scheduler_task[task_order[pos + 1]].timer.next - scheduler_task[id].timer.next) <= 0)
+    {
+        task_order[pos] = task_order[pos + 1];
+        pos++;
+    }
+    task_order[pos] = id;
+}
+
+void scheduler_init(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    task_num = sizeof(scheduler_task) / sizeof(task_t);
+
+    for (uint8_t i = 0; i < task_num; i++)
+    {
+        scheduler_task[i].last_run = now;
+        periodic_timer_start(&scheduler_task[i].timer, scheduler_task[i].rate_ms, PERIODIC_SKIP, now);
+        task_order[i] = i;
+    }
+    for (int8_t i = task_num - 1; i >= 0; i--)
+    {
+        task_reorder(i);
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    idle_window_start = DWT->CYCCNT;
+    idle_window_tick = now;
+}
+
+// 空闲率窗口结算
+static void scheduler_idle_account(uint32_t now)
+{
+    if (now - idle_window_tick >= IDLE_WINDOW_MS)
+    {
+        uint32_t window = DWT->CYCCNT - idle_window_start;
+        idle_percent = (uint8_t)((uint64_t)idle_cycles * 100 / window);
+        idle_cycles = 0;
+        idle_window_start = DWT->CYCCNT;
+        idle_window_tick = now;
+    }
+}
+
+// 无任务到期时休眠，由时基或外设中断唤醒
+// 关中断下执行WFI：挂起的中断仍可唤醒内核，中断服务在开中断后才执行，不计入空闲时间
+static void scheduler_idle(void)
+{
+    __disable_irq();
+    uint32_t start = DWT->CYCCNT;
+    __WFI();
+    idle_cycles += DWT->CYCCNT - start;
+    __enable_irq();
+}
+
+// 停节拍休眠：把SysTick重装值拉长到最近到期时刻，中途不再产生1ms节拍中断；
+// 醒来后按SysTick实际计数补齐uwTick，并把剩余的不足一拍部分装回，保持节拍相位。
+// ADC/DMA采集须持续运行，只进入Sleep模式，不进入Stop模式。
+static void scheduler_tickless_idle(void)
+{
+    uint32_t tick_cycles = SysTick->LOAD + 1;
+    uint32_t max_ms = SysTick_LOAD_RELOAD_Msk / tick_cycles;
+    uint32_t idle_ms, reload, slept, ticks, ctrl;
+
+    __disable_irq();
+    // 关中断后重新计算距最近到期的时间，节拍中断已挂起时放弃本次停节拍休眠
+    idle_ms = (uint32_t)(-periodic_timer_lateness(&scheduler_task[task_order[0]].timer, HAL_GetTick()));
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || (int32_t)idle_ms < TICKLESS_MIN_MS)
+    {
+        __enable_irq();
+        return;
+    }
+    if (idle_ms > max_ms)
+        idle_ms = max_ms;
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    reload = SysTick->VAL + tick_cycles * (idle_ms - 1);
+    SysTick->LOAD = reload;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+        // 定时到期：SysTick中断已挂起，开中断后由HAL_IncTick补上最后一拍
+        uint32_t overshoot = reload - SysTick->VAL;
+        if (overshoot > tick_cycles - 2)
+            overshoot = tick_cycles - 2;
+        slept = reload + 1 + overshoot;
+        ticks = idle_ms - 1;
+        SysTick->LOAD = tick_cycles - 1 - overshoot;
+
+        tickless_latency_last = overshoot;
+        if (overshoot > tickless_latency_max)
+            tickless_latency_max = overshoot;
+    }
+    else
+    {
+        // 被其它中断提前唤醒：按已走过的整拍数补齐，剩余部分作为下一拍
+        uint32_t value = SysTick->VAL;
+        uint32_t elapsed = tick_cycles * idle_ms - value; // 自上一拍边界起的周期数
+        slept = reload - value;
+        ticks = elapsed / tick_cycles;
+        SysTick->LOAD = (ticks + 1) * tick_cycles - elapsed - 1;
+        if (SysTick->LOAD == 0) // 恰在拍边界醒来，重装值为0会停止计数
+            SysTick->LOAD = tick_cycles - 1;
+        tick_edge_cycles = DWT->CYCCNT - (elapsed - ticks * tick_cycles);
+        tickless_early_wakes++;
+    }
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = tick_cycles - 1;
+
+    uwTick += ticks * uwTickFreq;
+    tickless_sleeps++;
+    tickless_sleep_cycles += slept;
+    idle_cycles += slept;
+    __enable_irq();
+}
+
+// SysTick中断中调用：记下当前节拍边界的DWT计数，按SysTick本拍已计的周期数回推，不含中断进入延迟。
+// 停节拍休眠定时醒来时本拍被缩短了overshoot，LOAD已恢复为整拍，LOAD - VAL仍是距边界的周期数
+void scheduler_tick_hook(void)
 {
-    task_num = sizeof(scheduler_task) / sizeof(task_t); 
+    tick_edge_cycles = DWT->CYCCNT - (SysTick->LOAD - SysTick->VAL);
 }
 
-void scheduler_run(void) 
+// 距节拍due的边界已过的DWT周期数；读取期间节拍前进则重读
+static uint32_t scheduler_late_cycles(uint32_t due)
 {
-    for (uint8_t i = 0; i < task_num; i++) 
+    uint32_t tick, edge;
+
+    do
     {
-        uint32_t now_time = HAL_GetTick(); 
-        
-        if (now_time >= scheduler_task[i].rate_ms + scheduler_task[i].last_run) 
+        tick = HAL_GetTick();
+        edge = tick_edge_cycles;
+    } while (tick != HAL_GetTick());
+
+    return (tick - due) * (SystemCoreClock / 1000) + (DWT->CYCCNT - edge);
+}
+
+// 运行一个到期任务：表头起的到期任务中取优先级最高者，运行后按新到期时刻重新排序；
+// 没有任务到期则休眠，距最近到期较远时停节拍休眠
+void scheduler_run(void)
+{
+    uint32_t now_time = HAL_GetTick();
+    uint8_t pick = 0;
+
+    scheduler_idle_account(now_time);
+    if (!task_due(now_time, task_order[0]))
+    {
+        int32_t idle_ms = -periodic_timer_lateness(&scheduler_task[task_order[0]].timer, now_time);
+
+        if (tickless_enabled && idle_ms >= TICKLESS_MIN_MS)
+            scheduler_tickless_idle();
+        else
+            scheduler_idle();
+        return;
+    }
+
+    for (uint8_t i = 1; i < task_num && task_due(now_time, task_order[i]); i++)
+    {
+        if (scheduler_task[task_order[i]].priority < scheduler_task[task_order[pick]].priority)
         {
-            scheduler_task[i].last_run = now_time; 
-            scheduler_task[i].task_func();         
+            pick = i;
         }
     }
+
+    task_t *task = &scheduler_task[task_order[pick]];
+    task_stats_t *stats = &task_stats[task_order[pick]];
+    uint32_t late_ms = (uint32_t)periodic_timer_lateness(&task->timer, now_time);
+    uint32_t due = task->timer.next;
+
+    task->last_run = now_time;
+    periodic_timer_expired(&task->timer, now_time);
+
+    uint32_t late_cycles = scheduler_late_cycles(due);
+    uint32_t start = DWT->CYCCNT;
+    task->task_func();
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    stats->runs++;
+    stats->total_cycles += cycles;
+    if (cycles < stats->min_cycles || stats->runs == 1)
+        stats->min_cycles = cycles;
+    if (cycles > stats->max_cycles)
+        stats->max_cycles = cycles;
+    if (cycles > max_loop_cycles)
+        max_loop_cycles = cycles;
+    if (late_ms >= task->rate_ms)
+        stats->deadline_miss++;
+    if (late_cycles > stats->max_jitter_cycles)
+        stats->max_jitter_cycles = late_cycles;
+
+    task_reorder(pick);
+}
+
+// 打印各任务运行统计并清零：次数、平均/最小/最大执行时间(us)、超期次数、最大启动延迟(us)
+void scheduler_print_stats(void)
+{
+    float us_per_cycle = 1e6f / SystemCoreClock;
+
+    my_printf(&huart1, "task      runs    avg_us   min_us   max_us  miss  jitter_us\r\n");
+    for (uint8_t i = 0; i < task_num; i++)
+    {
+        task_stats_t *stats = &task_stats[i];
+        float avg = stats->runs ? (float)stats->total_cycles / stats->runs : 0.0f;
+
+        my_printf(&huart1, "%-8s %6lu %9.1f %8.1f %8.1f %5lu %10.1f\r\n",
+                  scheduler_task[i].name, stats->runs,
+                  avg * us_per_cycle, stats->min_cycles * us_per_cycle, stats->max_cycles * us_per_cycle,
+                  stats->deadline_miss, stats->max_jitter_cycles * us_per_cycle);
+    }
+    my_printf(&huart1, "cpu idle: %d%%  max loop latency: %.1f us\r\n",
+              idle_percent, max_loop_cycles * us_per_cycle);
+    my_printf(&huart1, "tickless %s: %lu sleeps (%lu early), asleep %.1f ms, wake latency %.1f us (max %.1f us)\r\n",
+              tickless_enabled ? "on" : "off", tickless_sleeps, tickless_early_wakes,
+              tickless_sleep_cycles * us_per_cycle / 1000.0f,
+              tickless_latency_last * us_per_cycle, tickless_latency_max * us_per_cycle);
+
+    memset(task_stats, 0, sizeof(task_stats));
+    max_loop_cycles = 0;
+    tickless_sleeps = 0;
+    tickless_early_wakes = 0;
+    tickless_sleep_cycles = 0;
+    tickless_latency_max = 0;
+}
+
+// 获取最近一个统计窗口的CPU空闲率(%)
+uint8_t scheduler_get_idle_percent(void)
+{
+    return idle_percent;
+}
+
+// 开关停节拍休眠
+void scheduler_set_tickless(uint8_t enable)
+{
+    tickless_enabled = enable ? 1 : 0;
+}
+
+uint8_t scheduler_get_tickless(void)
+{
+    return tickless_enabled;
 }
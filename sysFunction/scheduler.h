@@ -2,8 +2,14 @@
 #define SCHEDULER_H
 
 #include "mydefine.h" 
+#include "periodic_timer.h"
 
 void scheduler_init(void); 
 void scheduler_run(void);  
+void scheduler_tick_hook(void);
+uint8_t scheduler_get_idle_percent(void); 
+void scheduler_print_stats(void);          
+void scheduler_set_tickless(uint8_t enable); 
+uint8_t scheduler_get_tickless(void);        
 
 #endif
@@ -169,6 +169,9 @@ void print_system_info(const system_info_t *info)
     my_printf(&huart1, "RTC: ");
     print_rtc_time();
 
+    my_printf(&huart1, "ADC dropped blocks: %lu\r\n", adc_get_dropped_blocks());
+    my_printf(&huart1, "CPU idle: %d%%\r\n", scheduler_get_idle_percent());
+
     my_printf(&huart1, "======system selftest======\r\n");
 }
 
@@ -1,4 +1,6 @@
 #include "usart_app.h"
+#include "clock_profile.h"
+#include "ring_bench.h"
 #include "stdlib.h"
 #include "stdarg.h"
 #include "string.h"
@@ -10,18 +12,22 @@
 uint16_t uart_rx_index = 0;
 uint32_t uart_rx_ticks = 0;
 uint8_t uart_rx_buffer[128] = {0};
-uint8_t uart_rx_dma_buffer[128] = {0};
-uint8_t uart_dma_buffer[128] = {0};
 uint8_t uart_flag = 0;
-struct rt_ringbuffer uart_ringbuffer;
-uint8_t ringbuffer_pool[128];
+
+// 串口接收环形缓冲：DMA直接写入环内空闲区，每条命令以0结尾提交，命令解析直接在环内进行
+#define UART_RX_RING_SIZE 256 // 2的幂
+#define UART_RX_SPAN_MIN 64   // 尾部连续空闲区短于该值时填0跳过，避免命令被拆成两段
+static uint8_t uart_rx_pool[UART_RX_RING_SIZE];
+static spsc_ring_t uart_rx_ring;
+static __IO uint8_t uart_rx_stalled = 0; // 缓冲区满，DMA接收已停止
 
 // 命令状态
 static cmd_state_t g_cmd_state = CMD_STATE_IDLE;
+static uint8_t g_config_save_reported = 0; // 由命令发起的配置保存，完成时输出结果
+static uint8_t g_cmd_channel = 0;
 
 // 采样输出相关变量
 uint8_t g_sampling_output_enabled = 0;
-uint32_t g_last_output_time = 0;
 
 output_format_t g_output_format = OUTPUT_FORMAT_NORMAL;
 
@@ -165,16 +171,27 @@ static void test_data_storage(void)
 {
 	my_printf(&huart1, "Testing data storage...\r\n");
 
+	sample_record_t record;
+	sampling_capture(&record);
+	for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+	{
+		record.voltage[ch] = 3.3f;
+	}
+	record.overlimit_mask = 0;
+	record.flags &= ~SAMPLE_REC_WAVE;
+
 	my_printf(&huart1, "Testing sample storage...\r\n");
-	data_storage_status_t result = data_storage_write_sample(3.3f);
+	data_storage_status_t result = data_storage_write_sample(&record);
 	my_printf(&huart1, "Sample storage result: %d\r\n", result);
 
 	my_printf(&huart1, "Testing overlimit storage...\r\n");
-	result = data_storage_write_overlimit(5.0f, 4.5f);
+	result = data_storage_write_overlimit(0, 5.0f, 4.5f);
 	my_printf(&huart1, "Overlimit storage result: %d\r\n", result);
 
 	my_printf(&huart1, "Testing hidedata storage...\r\n");
-	result = data_storage_write_hidedata(3.8f, 1);
+	record.voltage[0] = 3.8f;
+	record.overlimit_mask = 0x01;
+	result = data_storage_write_hidedata(&record);
 	my_printf(&huart1, "Hidedata storage result: %d\r\n", result);
 
 	my_printf(&huart1, "Data storage test completed.\r\n");
@@ -221,6 +238,29 @@ void format_hex_output(uint32_t timestamp, float voltage, uint8_t is_overlimit,
 }
 
 
+/// @brief 多通道隐藏格式输出，通道0之后依次追加各通道电压
+/// @param timestamp UNIX时间戳
+/// @param voltages 各通道电压
+/// @param overlimit_mask 超限通道位掩码
+/// @param output 输出缓冲，至少HEX_OUTPUT_SIZE字节
+void format_hex_channels(uint32_t timestamp, const float *voltages, uint8_t overlimit_mask, char *output)
+{
+	format_hex_output(timestamp, voltages[0], 0, output);
+
+	char *p = output + strlen(output);
+	for (uint8_t ch = 1; ch < ADC_CHANNEL_COUNT; ch++)
+	{
+		uint16_t int_part, dec_part;
+		convert_voltage_to_hex_format(voltages[ch], &int_part, &dec_part);
+		p += sprintf(p, "%04X%04X", int_part, dec_part);
+	}
+	if (overlimit_mask)
+	{
+		strcpy(p, "*");
+	}
+}
+
+
 static void test_hex_format_output(void)
 {
 
@@ -263,20 +303,76 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 }
 
 
+/// @brief 在接收环的空闲区上启动空闲中断DMA接收，预留1字节写命令结束符
+static void uart_rx_start(void)
+{
+	uint8_t *span;
+	uint32_t length = spsc_ring_reserve(&uart_rx_ring, &span);
+
+	// 尾部空闲区过短且开头还有空间：整段填0作为空命令提交，从缓冲区开头接收
+	if (length < UART_RX_SPAN_MIN && length < spsc_ring_free(&uart_rx_ring))
+	{
+		memset(span, 0, length);
+		spsc_ring_commit(&uart_rx_ring, length);
+		length = spsc_ring_reserve(&uart_rx_ring, &span);
+	}
+
+	if (length < 2)
+	{
+		uart_rx_stalled = 1;
+		return;
+	}
+	HAL_UARTEx_ReceiveToIdle_DMA(&huart1, span, length - 1);
+	__HAL_DMA_DISABLE_IT(&hdma_usart1_rx, DMA_IT_HT);
+}
+
+
+/// @brief 初始化串口接收环并启动DMA接收
+void uart_rx_init(void)
+{
+	spsc_ring_init(&uart_rx_ring, uart_rx_pool, sizeof(uart_rx_pool));
+	uart_rx_stalled = 0;
+	uart_rx_start();
+}
+
+
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
 	if (huart->Instance == USART1)
 	{
-		HAL_UART_DMAStop(huart);
+		uint8_t *span;
 
-		rt_ringbuffer_put(&uart_ringbuffer, uart_rx_dma_buffer, Size);
+		HAL_UART_DMAStop(huart);
 
-		memset(uart_rx_dma_buffer, 0, sizeof(uart_rx_dma_buffer));
+		// DMA写在保留区开头，补结束符后连同数据一起提交
+		if (Size > 0)
+		{
+			spsc_ring_reserve(&uart_rx_ring, &span);
+			span[Size] = '\0';
+			spsc_ring_commit(&uart_rx_ring, Size + 1);
+		}
+		uart_rx_start();
+#if APP_USE_RTOS
+		app_notify_uart_from_isr();
+#endif
+	}
+}
 
-		HAL_UARTEx_ReceiveToIdle_DMA(&huart1, uart_rx_dma_buffer, sizeof(uart_rx_dma_buffer));
 
-		__HAL_DMA_DISABLE_IT(&hdma_usart1_rx, DMA_IT_HT);
+/// @brief 解析命令中的通道号参数
+/// @param arg 参数字符串
+/// @param channel 输出通道号
+/// @return 1成功，0失败（已输出提示）
+static uint8_t parse_channel_arg(const char *arg, uint8_t *channel)
+{
+	int value;
+	if (sscanf(arg, "%d", &value) != 1 || value < 0 || value >= ADC_CHANNEL_COUNT)
+	{
+		my_printf(&huart1, "invalid channel (0~%d).\r\n", ADC_CHANNEL_COUNT - 1);
+		return 0;
 	}
+	*channel = (uint8_t)value;
+	return 1;
 }
 
 
@@ -310,6 +406,123 @@ void parse_uart_command(uint8_t *buffer, uint16_t length)
 	{
 		test_data_storage();
 	}
+	else if (strcmp((char *)buffer, "testadc") == 0)
+	{
+		adc_reduce_benchmark();
+	}
+	else if (strcmp((char *)buffer, "wave") == 0)
+	{
+		handle_wave_command();
+	}
+	else if (strcmp((char *)buffer, "wave on") == 0)
+	{
+		wave_analysis_flag = 1;
+		my_printf(&huart1, "wave analysis on\r\n");
+		data_storage_write_log("wave analysis on");
+	}
+	else if (strcmp((char *)buffer, "wave off") == 0)
+	{
+		wave_analysis_flag = 0;
+		my_printf(&huart1, "wave analysis off\r\n");
+		data_storage_write_log("wave analysis off");
+	}
+	else if (strcmp((char *)buffer, "fft") == 0)
+	{
+		handle_fft_command("");
+	}
+	else if (strncmp((char *)buffer, "fft ", 4) == 0)
+	{
+		handle_fft_command((char *)buffer + 4);
+	}
+	else if (strcmp((char *)buffer, "thd") == 0)
+	{
+		handle_thd_command();
+	}
+	else if (strncmp((char *)buffer, "thd ", 4) == 0)
+	{
+		float f0 = atof((char *)buffer + 4);
+		if (adc_harmonic_set_fundamental(f0))
+		{
+			char log_msg[48];
+			sprintf(log_msg, "thd fundamental set to %.1fHz", f0);
+			data_storage_write_log(log_msg);
+			handle_thd_command();
+		}
+		else
+		{
+			my_printf(&huart1, "fundamental invalid (%.0f-%.0fHz)\r\n", ADC_HARMONIC_F0_MIN, ADC_HARMONIC_F0_MAX);
+		}
+	}
+	else if (strcmp((char *)buffer, "trigger") == 0)
+	{
+		handle_trigger_command("");
+	}
+	else if (strncmp((char *)buffer, "trigger ", 8) == 0)
+	{
+		handle_trigger_command((char *)buffer + 8);
+	}
+	else if (strcmp((char *)buffer, "stats") == 0)
+	{
+#if APP_USE_RTOS
+		handle_thread_stats_command();
+#else
+		scheduler_print_stats();
+#endif
+	}
+	else if (strcmp((char *)buffer, "clock") == 0)
+	{
+		clock_profile_report();
+	}
+	else if (strncmp((char *)buffer, "clock ", 6) == 0)
+	{
+		handle_clock_command((char *)buffer + 6);
+	}
+	else if (strcmp((char *)buffer, "tickless on") == 0)
+	{
+		scheduler_set_tickless(1);
+		my_printf(&huart1, "tickless idle on\r\n");
+	}
+	else if (strcmp((char *)buffer, "tickless off") == 0)
+	{
+		scheduler_set_tickless(0);
+		my_printf(&huart1, "tickless idle off\r\n");
+	}
+	else if (strcmp((char *)buffer, "cache") == 0)
+	{
+		data_storage_cache_report();
+	}
+	else if (strncmp((char *)buffer, "cache ", 6) == 0)
+	{
+		handle_cache_command((char *)buffer + 6);
+	}
+	else if (strcmp((char *)buffer, "bin") == 0)
+	{
+		my_printf(&huart1, "binary sample records %s\r\n", data_storage_get_binary() ? "on" : "off");
+	}
+	else if (strcmp((char *)buffer, "bin on") == 0)
+	{
+		data_storage_set_binary(1);
+		data_storage_write_log("binary records on");
+		my_printf(&huart1, "binary sample records on\r\n");
+	}
+	else if (strcmp((char *)buffer, "bin off") == 0)
+	{
+		data_storage_set_binary(0);
+		data_storage_write_log("binary records off");
+		my_printf(&huart1, "binary sample records off\r\n");
+	}
+	else if (strcmp((char *)buffer, "testring") == 0)
+	{
+		ring_bench_run();
+	}
+	else if (strcmp((char *)buffer, "rate") == 0)
+	{
+		adc_rate_report();
+	}
+	else if (strncmp((char *)buffer, "rate ", 5) == 0)
+	{
+		handle_rate_command((char *)buffer + 5);
+	}
 	else if (strcmp((char *)buffer, "RTC Config") == 0)
 	{
 		handle_rtc_config_command();
@@ -325,12 +538,28 @@ void parse_uart_command(uint8_t *buffer, uint16_t length)
 	}
 	else if (strcmp((char *)buffer, "ratio") == 0)
 	{
+		g_cmd_channel = 0;
 		handle_ratio_command();
 	}
+	else if (strncmp((char *)buffer, "ratio ", 6) == 0)
+	{
+		if (parse_channel_arg((char *)buffer + 6, &g_cmd_channel))
+		{
+			handle_ratio_command();
+		}
+	}
 	else if (strcmp((char *)buffer, "limit") == 0)
 	{
+		g_cmd_channel = 0;
 		handle_limit_command();
 	}
+	else if (strncmp((char *)buffer, "limit ", 6) == 0)
+	{
+		if (parse_channel_arg((char *)buffer + 6, &g_cmd_channel))
+		{
+			handle_limit_command();
+		}
+	}
 
 	else if (strcmp((char *)buffer, "config save") == 0)
 	{
@@ -365,19 +594,55 @@ void parse_uart_command(uint8_t *buffer, uint16_t length)
 
 void uart_task(void)
 {
-	uint16_t length;
+	uint8_t *span;
+	uint32_t length;
 
-	length = rt_ringbuffer_data_len(&uart_ringbuffer);
-
-	if (length > 0)
+	// 逐条取出以0结尾的命令，在环内原地解析后归还
+	while ((length = spsc_ring_acquire(&uart_rx_ring, &span)) > 0)
 	{
-		rt_ringbuffer_get(&uart_ringbuffer, uart_dma_buffer, length);
+		uint8_t *end = memchr(span, '\0', length);
+		if (end == NULL)
+		{
+			break;
+		}
+		if (end > span)
+		{
+			parse_uart_command(span, (uint16_t)(end - span));
+		}
+		spsc_ring_release(&uart_rx_ring, (uint32_t)(end - span) + 1);
+	}
 
-		parse_uart_command(uart_dma_buffer, length);
-		memset(uart_dma_buffer, 0, sizeof(uart_dma_buffer));
+	// 接收因缓冲区满而停止时，腾出空间后重新启动
+	if (uart_rx_stalled)
+	{
+		uart_rx_stalled = 0;
+		uart_rx_start();
 	}
+}
 
-	handle_sampling_output();
+
+/// @brief 打印各通道ratio/limit，单通道时保持原有格式
+/// @param params 配置参数
+/// @param ratio_name ratio显示名
+/// @param limit_name limit显示名
+/// @param sep 名称与数值分隔符
+/// @param value_fmt 数值格式
+static void print_channel_params(const config_params_t *params, const char *ratio_name, const char *limit_name, const char *sep, const char *value_fmt)
+{
+	char line[48];
+	const char *names[2] = {ratio_name, limit_name};
+	const float *values[2] = {params->ratio, params->limit};
+
+	for (uint8_t k = 0; k < 2; k++)
+	{
+		for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+		{
+			int n = (ch == 0) ? sprintf(line, "%s%s", names[k], sep)
+							  : sprintf(line, "%s(ch%d)%s", names[k], ch, sep);
+			n += sprintf(line + n, value_fmt, values[k][ch]);
+			my_printf(&huart1, "%s\r\n", line);
+		}
+	}
 }
 
 
@@ -386,7 +651,13 @@ void handle_conf_command(void)
 	ini_config_t ini_config;
 	config_params_t config_params;
 	data_storage_write_log("conf command");
+#if APP_USE_RTOS
+	app_fs_lock();
+#endif
 	ini_status_t ini_status = ini_parse_file("config.ini", &ini_config);
+#if APP_USE_RTOS
+	app_fs_unlock();
+#endif
 
 	if (ini_status == INI_FILE_NOT_FOUND)
 	{
@@ -398,44 +669,53 @@ void handle_conf_command(void)
 		my_printf(&huart1, "config.ini format error.\r\n");
 		return;
 	}
-	if (!ini_config.ratio_found || !ini_config.limit_found)
+	if (!(ini_config.ratio_found & 0x01) || !(ini_config.limit_found & 0x01))
 	{
 		my_printf(&huart1, "config.ini missing parameters.\r\n");
 		return;
 	}
-	if (config_validate_ratio(ini_config.ratio) != CONFIG_OK)
-	{
-		my_printf(&huart1, "ratio parameter out of range (0-100).\r\n");
-		return;
-	}
-
-	if (config_validate_limit(ini_config.limit) != CONFIG_OK)
-	{
-		my_printf(&huart1, "limit parameter out of range (0-500).\r\n");
-		return;
-	}
 	if (config_get_params(&config_params) != CONFIG_OK)
 	{
 		my_printf(&huart1, "config system error.\r\n");
 		return;
 	}
-	config_params.ratio = ini_config.ratio;
-	config_params.limit = ini_config.limit;
+	// 未给出的ChN保持当前配置
+	for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+	{
+		if (ini_config.ratio_found & (1 << ch))
+		{
+			if (config_validate_ratio(ini_config.ratio[ch]) != CONFIG_OK)
+			{
+				my_printf(&huart1, "ratio parameter out of range (0-100).\r\n");
+				return;
+			}
+			config_params.ratio[ch] = ini_config.ratio[ch];
+		}
+		if (ini_config.limit_found & (1 << ch))
+		{
+			if (config_validate_limit(ini_config.limit[ch]) != CONFIG_OK)
+			{
+				my_printf(&huart1, "limit parameter out of range (0-500).\r\n");
+				return;
+			}
+			config_params.limit[ch] = ini_config.limit[ch];
+		}
+	}
 	if (config_set_params(&config_params) != CONFIG_OK)
 	{
 		my_printf(&huart1, "config update failed.\r\n");
 		return;
 	}
-	if (config_save_to_flash() != CONFIG_OK)
+	if (config_save_to_flash() != CONFIG_PENDING)
 	{
 		my_printf(&huart1, "config save to flash failed.\r\n");
 		return;
 	}
-	my_printf(&huart1, "Ratio = %.1f\r\n", ini_config.ratio);
-	my_printf(&huart1, "Limit = %.1f\r\n", ini_config.limit);
+	g_config_save_reported = 1;
+	print_channel_params(&config_params, "Ratio", "Limit", " = ", "%.1f");
 	my_printf(&huart1, "config read success\r\n");
 	char log_msg[128];
-	sprintf(log_msg, "config read success - ratio %.1f, limit %.1f", ini_config.ratio, ini_config.limit);
+	sprintf(log_msg, "config read success - ratio %.1f, limit %.1f", config_params.ratio[0], config_params.limit[0]);
 	data_storage_write_log(log_msg);
 }
 
@@ -449,7 +729,7 @@ void handle_ratio_command(void)
 		my_printf(&huart1, "config system error.\r\n");
 		return;
 	}
-	my_printf(&huart1, "Ratio=%.1f\r\n", config_params.ratio);
+	my_printf(&huart1, "Ratio=%.1f\r\n", config_params.ratio[g_cmd_channel]);
 	my_printf(&huart1, "Input value(0~100):\r\n");
 	g_cmd_state = CMD_STATE_WAIT_RATIO;
 }
@@ -477,17 +757,17 @@ void handle_interactive_input(char *input)
 		if (config_validate_ratio(value) != CONFIG_OK)
 		{
 			my_printf(&huart1, "ratio invalid\r\n");
-			my_printf(&huart1, "Ratio = %.1f\r\n", config_params.ratio);
+			my_printf(&huart1, "Ratio = %.1f\r\n", config_params.ratio[g_cmd_channel]);
 		}
 		else
 		{
-			config_params.ratio = value;
+			config_params.ratio[g_cmd_channel] = value;
 			if (config_set_params(&config_params) == CONFIG_OK)
 			{
 				my_printf(&huart1, "ratio modified success\r\n");
 				my_printf(&huart1, "Ratio = %.1f\r\n", value);
 				char log_msg[64];
-				sprintf(log_msg, "ratio config success to %.1f", value);
+				sprintf(log_msg, "ratio config success to %.1f (ch%d)", value, g_cmd_channel);
 				data_storage_write_log(log_msg);
 			}
 			else
@@ -502,17 +782,17 @@ void handle_interactive_input(char *input)
 		if (config_validate_limit(value) != CONFIG_OK)
 		{
 			my_printf(&huart1, "limit invalid\r\n");
-			my_printf(&huart1, "limit = %.2f\r\n", config_params.limit);
+			my_printf(&huart1, "limit = %.2f\r\n", config_params.limit[g_cmd_channel]);
 		}
 		else
 		{
-			config_params.limit = value;
+			config_params.limit[g_cmd_channel] = value;
 			if (config_set_params(&config_params) == CONFIG_OK)
 			{
 				my_printf(&huart1, "limit modified success\r\n");
 				my_printf(&huart1, "limit = %.2f\r\n", value);
 				char log_msg[64];
-				sprintf(log_msg, "limit config success to %.1f", value);
+				sprintf(log_msg, "limit config success to %.1f (ch%d)", value, g_cmd_channel);
 				data_storage_write_log(log_msg);
 			}
 			else
@@ -552,7 +832,7 @@ void handle_limit_command(void)
 		my_printf(&huart1, "config system error.\r\n");
 		return;
 	}
-	my_printf(&huart1, "limit=%.1f\r\n", config_params.limit);
+	my_printf(&huart1, "limit=%.1f\r\n", config_params.limit[g_cmd_channel]);
 	my_printf(&huart1, "Input value(0~200):\r\n");
 	g_cmd_state = CMD_STATE_WAIT_LIMIT;
 }
@@ -565,20 +845,44 @@ void handle_configsave_command(void)
 		my_printf(&huart1, "config system error.\r\n");
 		return;
 	}
-	my_printf(&huart1, "ratio: %.2f\r\n", config_params.ratio);
-	my_printf(&huart1, "limit: %.2f\r\n", config_params.limit);
-	if (config_save_to_flash() != CONFIG_OK)
+	print_channel_params(&config_params, "ratio", "limit", ": ", "%.2f");
+	if (config_save_to_flash() != CONFIG_PENDING)
 	{
 		my_printf(&huart1, "save parameters to flash failed.\r\n");
 		return;
 	}
-	my_printf(&huart1, "save parameters to flash\r\n");
+	g_config_save_reported = 1;
+	my_printf(&huart1, "saving parameters to flash...\r\n");
+}
+
+/// @brief 配置保存完成回调：命令发起的保存输出结果，任何保存失败都输出并记日志
+/// @param status CONFIG_OK或CONFIG_FLASH_ERROR
+void handle_config_saved(config_status_t status)
+{
+	if (status == CONFIG_OK)
+	{
+		if (g_config_save_reported)
+		{
+			my_printf(&huart1, "save parameters to flash done\r\n");
+		}
+	}
+	else
+	{
+		my_printf(&huart1, "save parameters to flash failed, verify error.\r\n");
+		data_storage_write_log("config save verify failed");
+	}
+	g_config_save_reported = 0;
 }
 
 void handle_configread_command(void)
 {
 	config_params_t config_params;
 	config_status_t status = config_load_from_flash();
+	if (status == CONFIG_PENDING)
+	{
+		my_printf(&huart1, "config save in progress, try again.\r\n");
+		return;
+	}
 	if (status != CONFIG_OK)
 	{
 		my_printf(&huart1, "read parameters from flash failed.\r\n");
@@ -590,8 +894,7 @@ void handle_configread_command(void)
 		my_printf(&huart1, "config system error.\r\n");
 		return;
 	}
-	my_printf(&huart1, "ratio: %.2f\r\n", config_params.ratio);
-	my_printf(&huart1, "limit: %.2f\r\n", config_params.limit);
+	print_channel_params(&config_params, "ratio", "limit", ": ", "%.2f");
 }
 
 
@@ -607,7 +910,6 @@ void handle_start_command(void)
 	sampling_cycle_t cycle = sampling_get_cycle();
 	my_printf(&huart1, "sample cycle: %ds\r\n", (int)cycle);
 	g_sampling_output_enabled = 1;
-	g_last_output_time = HAL_GetTick();
 	char log_msg[64];
 	sprintf(log_msg, "sample start - cycle %ds (command)", (int)cycle);
 	data_storage_write_log(log_msg);
@@ -628,101 +930,295 @@ void handle_stop_command(void)
 }
 
 
-void handle_sampling_output(void)
+/// @brief 采样总线订阅者：按当前输出格式打印采样记录
+/// @param record 采样记录
+void handle_sampling_output(const sample_record_t *record)
 {
 	if (!g_sampling_output_enabled)
 	{
 		return;
 	}
-	if (sampling_get_state() != SAMPLING_ACTIVE)
+	if (g_output_format == OUTPUT_FORMAT_HIDDEN)
 	{
+		char hex_output[HEX_OUTPUT_SIZE];
+
+		format_hex_channels(record->time, record->voltage, record->overlimit_mask, hex_output);
+		my_printf(&huart1, "%s\r\n", hex_output);
 		return;
 	}
-	uint32_t current_time = HAL_GetTick();
-	sampling_cycle_t cycle = sampling_get_cycle();
-	uint32_t cycle_ms = cycle * 1000;
 
-	if (current_time - g_last_output_time >= cycle_ms)
+	char line[32 + ADC_CHANNEL_COUNT * 96];
+	char *p = line;
+
+	p += sprintf(p, "%04d-%02d-%02d %02d:%02d:%02d",
+				 record->rtc_date.Year + 2000,
+				 record->rtc_date.Month,
+				 record->rtc_date.Date,
+				 record->rtc_time.Hours,
+				 record->rtc_time.Minutes,
+				 record->rtc_time.Seconds);
+	for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
 	{
-		g_last_output_time = current_time;
-		RTC_TimeTypeDef current_rtc_time = {0};
-		RTC_DateTypeDef current_rtc_date = {0};
-		HAL_RTC_GetTime(&hrtc, &current_rtc_time, RTC_FORMAT_BIN);
-		HAL_RTC_GetDate(&hrtc, &current_rtc_date, RTC_FORMAT_BIN);
-		float voltage = sampling_get_voltage();
-		uint8_t is_overlimit = sampling_check_overlimit();
-		if (g_output_format == OUTPUT_FORMAT_HIDDEN)
-		{
-			uint32_t timestamp = convert_rtc_to_unix_timestamp(&current_rtc_time, &current_rtc_date);
-			char hex_output[32];
+		const sample_wave_t *wave = &record->wave[ch];
 
-			format_hex_output(timestamp, voltage, is_overlimit, hex_output);
-			my_printf(&huart1, "%s\r\n", hex_output);
-		}
-		else
+		p += sprintf(p, " ch%d=%.2fV", ch, record->voltage[ch]);
+		if (record->overlimit_mask & (1 << ch))
 		{
-			if (is_overlimit)
+			if (record->flags & SAMPLE_REC_CONFIG_OK)
 			{
-				config_params_t config_params;
-				if (config_get_params(&config_params) == CONFIG_OK)
-				{
-					my_printf(&huart1, "%04d-%02d-%02d %02d:%02d:%02d ch0=%.2fV OverLimit(%.2f)!\r\n",
-							  current_rtc_date.Year + 2000,
-							  current_rtc_date.Month,
-							  current_rtc_date.Date,
-							  current_rtc_time.Hours,
-							  current_rtc_time.Minutes,
-							  current_rtc_time.Seconds,
-							  voltage,
-							  config_params.limit);
-				}
-				else
-				{
-					my_printf(&huart1, "%04d-%02d-%02d %02d:%02d:%02d ch0=%.2fV OverLimit!!\r\n",
-							  current_rtc_date.Year + 2000,
-							  current_rtc_date.Month,
-							  current_rtc_date.Date,
-							  current_rtc_time.Hours,
-							  current_rtc_time.Minutes,
-							  current_rtc_time.Seconds,
-							  voltage);
-				}
+				p += sprintf(p, " OverLimit(%.2f)!", record->limit[ch]);
 			}
 			else
 			{
-				my_printf(&huart1, "%04d-%02d-%02d %02d:%02d:%02d ch0=%.2fV\r\n",
-						  current_rtc_date.Year + 2000,
-						  current_rtc_date.Month,
-						  current_rtc_date.Date,
-						  current_rtc_time.Hours,
-						  current_rtc_time.Minutes,
-						  current_rtc_time.Seconds,
-						  voltage);
+				p += sprintf(p, " OverLimit!!");
 			}
 		}
-		if (g_output_format == OUTPUT_FORMAT_HIDDEN)
+		if (wave->valid & SAMPLE_WAVE_STATS)
+		{
+			p += sprintf(p, " rms=%.2fV pp=%.2fV cf=%.2f", wave->rms, wave->peak_to_peak, wave->crest_factor);
+		}
+		if (wave->valid & SAMPLE_WAVE_THD)
 		{
+			p += sprintf(p, " thd=%.1f%%", wave->thd);
+		}
+	}
+	my_printf(&huart1, "%s\r\n", line);
+}
+
+
+void handle_wave_command(void)
+{
+	adc_wave_stats_t wave;
 
-			data_storage_status_t result = data_storage_write_hidedata(voltage, is_overlimit);
+	my_printf(&huart1, "wave analysis: %s\r\n", wave_analysis_flag ? "on" : "off");
+	for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+	{
+		if (!sampling_get_wave_stats(ch, &wave))
+		{
+			continue;
 		}
-		else
+		my_printf(&huart1, "ch%d mean=%.3fV rms=%.3fV std=%.3fV\r\n", ch, wave.mean, wave.rms, wave.std_dev);
+		my_printf(&huart1, "ch%d min=%.3fV max=%.3fV pp=%.3fV cf=%.2f\r\n", ch, wave.min, wave.max, wave.peak_to_peak, wave.crest_factor);
+	}
+}
+
+
+void handle_trigger_command(char *args)
+{
+	static const char *state_names[] = {"disarmed", "armed", "post", "frozen"};
+	unsigned long pre_ms, post_ms;
+
+	if (strcmp(args, "on") == 0)
+	{
+		adc_trigger_enable(1);
+		data_storage_write_log("trigger on");
+	}
+	else if (strcmp(args, "off") == 0)
+	{
+		adc_trigger_enable(0);
+		data_storage_write_log("trigger off");
+	}
+	else if (sscanf(args, "%lu %lu", &pre_ms, &post_ms) == 2)
+	{
+		if (!adc_trigger_set_window(pre_ms, post_ms))
 		{
-			data_storage_status_t result = data_storage_write_sample(voltage);
+			my_printf(&huart1, "window invalid (0-60000ms)\r\n");
+			return;
 		}
+		char log_msg[48];
+		sprintf(log_msg, "trigger window %lums/%lums", pre_ms, post_ms);
+		data_storage_write_log(log_msg);
+	}
+	else if (args[0] != '\0')
+	{
+		my_printf(&huart1, "Usage: trigger [on|off|<pre_ms> <post_ms>]\r\n");
+		return;
+	}
+
+	uint32_t pre, post;
+	adc_trigger_get_window(&pre, &post);
+	my_printf(&huart1, "trigger: %s, %s\r\n", adc_trigger_is_enabled() ? "on" : "off", state_names[adc_trigger_get_state()]);
+	my_printf(&huart1, "window: pre %lums, post %lums (ring %d blocks)\r\n", pre, post, ADC_TRIGGER_RING_BLOCKS);
+	my_printf(&huart1, "bursts: %lu, missed: %lu\r\n", adc_trigger_get_count(), adc_trigger_get_missed());
+}
+
+
+void handle_thd_command(void)
+{
+	adc_harmonic_result_t harmonics;
+	char line[16 + ADC_HARMONIC_COUNT * 12];
 
-		if (is_overlimit)
+	my_printf(&huart1, "fundamental: %.1fHz, cpu: %lu cycles/block\r\n", adc_harmonic_get_fundamental(), adc_get_harmonic_cycles());
+	for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+	{
+		if (!sampling_get_harmonics(ch, &harmonics) || harmonics.count == 0)
 		{
-			config_params_t config_params;
-			float limit_value = 0.0f;
-			if (config_get_params(&config_params) == CONFIG_OK)
-			{
-				limit_value = config_params.limit;
-			}
+			continue;
+		}
+		char *p = line;
+		for (uint8_t h = 0; h < harmonics.count; h++)
+		{
+			p += sprintf(p, " h%d=%.3f", h + 1, harmonics.amp[h]);
+		}
+		my_printf(&huart1, "ch%d THD=%.2f%%%s\r\n", ch, harmonics.thd, line);
+	}
+}
 
-			data_storage_status_t result = data_storage_write_overlimit(voltage, limit_value);
+
+void handle_fft_command(char *args)
+{
+	static adc_spectrum_result_t result;
+	int channel = 0;
+	char option[8] = {0};
+
+	sscanf(args, "%d %7s", &channel, option);
+	if (channel < 0 || channel >= ADC_CHANNEL_COUNT)
+	{
+		my_printf(&huart1, "channel invalid (0-%d)\r\n", ADC_CHANNEL_COUNT - 1);
+		return;
+	}
+	if (!sampling_get_spectrum((uint8_t)channel, &result))
+	{
+		my_printf(&huart1, "fft failed\r\n");
+		return;
+	}
+
+	my_printf(&huart1, "FFT ch%d: %d points, %.2f Hz/bin\r\n", channel, result.fft_len, result.bin_hz);
+	my_printf(&huart1, "dc=%.3fV ac_rms=%.3fV\r\n", result.dc, result.total_rms);
+	for (uint8_t i = 0; i < ADC_SPECTRUM_PEAKS; i++)
+	{
+		my_printf(&huart1, "peak%d: %.1fHz %.3fV\r\n", i + 1, result.peak_freq[i], result.peak_amp[i]);
+	}
+	float band_hz = result.bin_hz * result.fft_len / 2 / ADC_SPECTRUM_BANDS;
+	for (uint8_t b = 0; b < ADC_SPECTRUM_BANDS; b++)
+	{
+		my_printf(&huart1, "band %.0f-%.0fHz: %.1f%%\r\n", b * band_hz, (b + 1) * band_hz, result.band_energy[b]);
+	}
+
+	if (strcmp(option, "log") == 0)
+	{
+		char log_msg[64];
+		sprintf(log_msg, "fft ch%d peak %.1fHz %.2fV rms %.2fV", channel, result.peak_freq[0], result.peak_amp[0], result.total_rms);
+		data_storage_write_log(log_msg);
+	}
+}
+
+
+void handle_rate_command(char *args)
+{
+	unsigned long rate_hz;
+	int ratio = adc_decimate_get_ratio();
+	int parsed = sscanf(args, "%lu %d", &rate_hz, &ratio);
+
+	if (parsed < 1)
+	{
+		my_printf(&huart1, "Usage: rate <hz> [decimation]\r\n");
+		return;
+	}
+	// 两个参数都检查通过后再生效，避免只改了一半
+	if (ratio < 0 || !adc_decimate_ratio_valid((uint32_t)ratio))
+	{
+		my_printf(&huart1, "decimation invalid (1,2,4..%d)\r\n", ADC_DECIMATE_MAX);
+		return;
+	}
+	if (!adc_sample_rate_valid(rate_hz))
+	{
+		my_printf(&huart1, "rate invalid\r\n");
+		return;
+	}
+	adc_decimate_set_ratio((uint16_t)ratio);
+	uint32_t actual = adc_set_sample_rate(rate_hz);
+	adc_rate_report();
+	char log_msg[64];
+	sprintf(log_msg, "sample rate set to %luHz, decimation %d", actual, ratio);
+	data_storage_write_log(log_msg);
+}
+
+void handle_clock_command(char *args)
+{
+	clock_profile_t profile;
+	char log_msg[48];
+
+	if (strcmp(args, "auto") == 0)
+	{
+		clock_profile_set_auto(1);
+		data_storage_write_log("clock profile auto");
+		my_printf(&huart1, "clock profile auto\r\n");
+		return;
+	}
+	if (!clock_profile_parse(args, &profile))
+	{
+		my_printf(&huart1, "Usage: clock [low|normal|high|auto]\r\n");
+		return;
+	}
+
+	clock_profile_set_auto(0);
+	if (clock_profile_set(profile) != CLOCK_PROFILE_OK)
+	{
+		my_printf(&huart1, "clock switch failed\r\n");
+	}
+	clock_profile_report();
+	sprintf(log_msg, "clock profile %s", clock_profile_name(clock_profile_get()));
+	data_storage_write_log(log_msg);
+}
+
+void handle_cache_command(char *args)
+{
+	storage_cache_policy_t policy;
+	char log_msg[48];
+
+	data_storage_get_cache_policy(&policy);
+	if (strcmp(args, "flush") == 0)
+	{
+		data_storage_flush();
+		my_printf(&huart1, "cache flush requested\r\n");
+		return;
+	}
+	else if (strncmp(args, "records ", 8) == 0)
+	{
+		int records = atoi(args + 8);
+		if (records < 1 || records > 255)
+		{
+			my_printf(&huart1, "records must be 1-255\r\n");
+			return;
 		}
+		policy.max_records = (uint8_t)records;
+	}
+	else if (strncmp(args, "age ", 4) == 0)
+	{
+		policy.max_age_ms = strtoul(args + 4, NULL, 10);
+	}
+	else if (strcmp(args, "stop on") == 0 || strcmp(args, "stop off") == 0)
+	{
+		policy.flush_on_stop = (strcmp(args, "stop on") == 0);
+	}
+	else
+	{
+		my_printf(&huart1, "Usage: cache [flush|records <n>|age <ms>|stop <on|off>]\r\n");
+		return;
+	}
+
+	data_storage_set_cache_policy(&policy);
+	data_storage_cache_report();
+	sprintf(log_msg, "cache %.32s", args);
+	data_storage_write_log(log_msg);
+}
+
+#if APP_USE_RTOS
+void handle_thread_stats_command(void)
+{
+	app_thread_stats_t stats;
+
+	my_printf(&huart1, "thread     runs  max_wait_ms  overruns\r\n");
+	for (uint8_t i = 0; i < APP_THREAD_COUNT; i++)
+	{
+		app_threads_get_stats((app_thread_id_t)i, &stats);
+		my_printf(&huart1, "%-8s %6lu %12lu %9lu\r\n",
+				  app_threads_get_name((app_thread_id_t)i), stats.runs, stats.max_wait_ms, stats.overruns);
 	}
+	adc_rate_report();
 }
+#endif
 
 
 void handle_hide_command(void)
@@ -3,9 +3,14 @@
 
 #include "mydefine.h"     
 #include "data_storage.h" 
+#include "adc_channel.h"
+#include "periodic_timer.h"
+#include "sample_bus.h"
+#include "config_manager.h"
 
 int my_printf(UART_HandleTypeDef *huart, const char *format, ...);        
 void uart_task(void);                                                     
+void uart_rx_init(void);                                                  
 void parse_uart_command(uint8_t *buffer, uint16_t length);                
 
 typedef enum 
@@ -32,14 +37,26 @@ void handle_stop_command(void);
 void handle_hide_command(void);             
 void handle_unhide_command(void);           
 void handle_rtc_config_command(void);       
-void handle_sampling_output(void);         
+void handle_rate_command(char *args);       
+void handle_wave_command(void);             
+void handle_fft_command(char *args);        
+void handle_thd_command(void);              
+void handle_trigger_command(char *args);    
+void handle_thread_stats_command(void);     
+void handle_clock_command(char *args);
+void handle_cache_command(char *args);      
+void handle_sampling_output(const sample_record_t *record);
+void handle_config_saved(config_status_t status);
 void handle_interactive_input(char *input); 
 
 uint32_t convert_rtc_to_unix_timestamp(RTC_TimeTypeDef *time, RTC_DateTypeDef *date);          
 void format_hex_output(uint32_t timestamp, float voltage, uint8_t is_overlimit, char *output); 
+void format_hex_channels(uint32_t timestamp, const float *voltages, uint8_t overlimit_mask, char *output);
+
+// 隐藏格式输出长度：8位时间戳+每通道8位电压+超限标记
+#define HEX_OUTPUT_SIZE (8 + ADC_CHANNEL_COUNT * 8 + 2)
 
 extern uint8_t g_sampling_output_enabled; 
-extern uint32_t g_last_output_time;        
 extern output_format_t g_output_format;    
 
 #endif
@@ -0,0 +1,364 @@
+// 二进制采样记录(bin/sampleData*.bin)转CSV，记录格式见sysFunction/sample_bin.h。
+// 整个文件一次读入，逐条校验CRC后按整数运算格式化，输出经大缓冲区批量写出。
+//
+// 编译：
+//   g++ -O2 -std=c++17 -I../../sysFunction -o bin2csv bin2csv.cpp
+// 运行：
+//   ./bin2csv [-o 输出.csv] 文件.bin...
+// 不指定-o时输出到标准输出；多个文件按参数顺序拼接，只输出一次表头。
+// 记录数、CRC错误与序号跳变统计输出到标准错误。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sample_bin.h"
+
+namespace
+{
+
+constexpr size_t kFlushBytes = 1 << 20;
+constexpr size_t kSectorSize = 512;
+
+struct FileStats
+{
+    uint64_t records = 0;
+    uint64_t crc_errors = 0;
+    uint64_t sequence_gaps = 0;
+    uint64_t trailing_bytes = 0;
+};
+
+template <typename T>
+T load(const uint8_t *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+bool read_file(const char *path, std::vector<uint8_t> &data)
+{
+    FILE *fp = std::fopen(path, "rb");
+    if (fp == nullptr)
+        return false;
+
+    std::fseek(fp, 0, SEEK_END);
+    long size = std::ftell(fp);
+    std::fseek(fp, 0, SEEK_SET);
+    if (size < 0)
+    {
+        std::fclose(fp);
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(size));
+    size_t got = data.empty() ? 0 : std::fread(data.data(), 1, data.size(), fp);
+    std::fclose(fp);
+    return got == data.size();
+}
+
+// 固定宽度无符号整数，高位补0
+void append_padded(std::string &out, uint32_t value, int width)
+{
+    char digits[10];
+    for (int i = width - 1; i >= 0; i--)
+    {
+        digits[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out.append(digits, static_cast<size_t>(width));
+}
+
+void append_uint(std::string &out, uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+    do
+    {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0)
+        out.push_back(digits[--n]);
+}
+
+// Q16.16定点按5位小数输出(分辨率1/65536约1.5e-5)，四舍五入
+void append_q16(std::string &out, int32_t raw)
+{
+    uint64_t magnitude = raw < 0 ? static_cast<uint64_t>(-static_cast<int64_t>(raw)) : static_cast<uint64_t>(raw);
+    uint64_t scaled = (magnitude * 100000 + 32768) >> 16;
+
+    if (raw < 0 && scaled != 0)
+        out.push_back('-');
+    append_uint(out, scaled / 100000);
+    out.push_back('.');
+    append_padded(out, static_cast<uint32_t>(scaled % 100000), 5);
+}
+
+// Unix秒转"YYYY-MM-DD HH:MM:SS"，同一秒内的记录复用上次结果
+class TimeFormatter
+{
+public:
+    const std::string &format(uint32_t time)
+    {
+        if (time == cached_time_ && !cached_.empty())
+            return cached_;
+
+        int64_t days = time / 86400;
+        uint32_t seconds = time % 86400;
+
+        // 公历日期换算(Howard Hinnant civil_from_days)
+        int64_t z = days + 719468;
+        int64_t era = z / 146097;
+        uint32_t doe = static_cast<uint32_t>(z - era * 146097);
+        uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        uint32_t mp = (5 * doy + 2) / 153;
+        uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+        uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+        uint32_t year = static_cast<uint32_t>(yoe + era * 400 + (month <= 2));
+
+        cached_.clear();
+        append_padded(cached_, year, 4);
+        cached_.push_back('-');
+        append_padded(cached_, month, 2);
+        cached_.push_back('-');
+        append_padded(cached_, day, 2);
+        cached_.push_back(' ');
+        append_padded(cached_, seconds / 3600, 2);
+        cached_.push_back(':');
+        append_padded(cached_, seconds / 60 % 60, 2);
+        cached_.push_back(':');
+        append_padded(cached_, seconds % 60, 2);
+        cached_time_ = time;
+        return cached_;
+    }
+
+private:
+    uint32_t cached_time_ = 0;
+    std::string cached_;
+};
+
+class Converter
+{
+public:
+    explicit Converter(FILE *out) : out_(out)
+    {
+        buffer_.reserve(kFlushBytes + 4096);
+    }
+
+    ~Converter()
+    {
+        flush();
+    }
+
+    bool convert(const char *path, FileStats &stats)
+    {
+        std::vector<uint8_t> data;
+        if (!read_file(path, data))
+        {
+            std::fprintf(stderr, "%s: cannot read\n", path);
+            return false;
+        }
+
+        sample_bin_header_t header;
+        if (!parse_header(path, data, header))
+            return false;
+
+        if (channels_ == 0)
+        {
+            channels_ = header.channels;
+            write_column_names();
+        }
+        else if (channels_ != header.channels)
+        {
+            std::fprintf(stderr, "%s: %u channels, expected %u\n", path, header.channels, channels_);
+            return false;
+        }
+
+        const uint8_t *p = data.data() + header.header_size;
+        const uint8_t *end = data.data() + data.size();
+        const size_t record_size = header.record_size;
+        const size_t sequence_offset = SAMPLE_BIN_VALUE_OFFSET + 4 * header.channels;
+        uint32_t expected_sequence = 0;
+
+        for (; static_cast<size_t>(end - p) >= record_size; p += record_size)
+        {
+            if (sample_bin_crc16(p, static_cast<uint32_t>(record_size - 2)) != load<uint16_t>(p + record_size - 2))
+            {
+                if (is_padding(data.data(), p, end, record_size))
+                    break;
+                stats.crc_errors++;
+                continue;
+            }
+
+            uint16_t sequence = load<uint16_t>(p + sequence_offset);
+            if (sequence != expected_sequence)
+                stats.sequence_gaps++;
+            expected_sequence = static_cast<uint16_t>(sequence + 1);
+
+            write_record(p, header, sequence);
+            stats.records++;
+        }
+        stats.trailing_bytes = static_cast<uint64_t>(end - p);
+        return true;
+    }
+
+private:
+    // 未关闭的预分配文件(掉电)保持预分配大小，数据之后是补0的扇区：
+    // 从记录起点到其所在扇区末尾全为0即为数据末尾，其后按trailing bytes计
+    static bool is_padding(const uint8_t *begin, const uint8_t *p, const uint8_t *end, size_t record_size)
+    {
+        size_t offset = static_cast<size_t>(p - begin);
+        size_t length = kSectorSize - offset % kSectorSize;
+        if (length > record_size)
+            length = record_size;
+        if (length > static_cast<size_t>(end - p))
+            length = static_cast<size_t>(end - p);
+        for (size_t i = 0; i < length; i++)
+        {
+            if (p[i] != 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool parse_header(const char *path, const std::vector<uint8_t> &data, sample_bin_header_t &header)
+    {
+        if (data.size() < sizeof(header))
+        {
+            std::fprintf(stderr, "%s: file shorter than header\n", path);
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != SAMPLE_BIN_MAGIC)
+        {
+            std::fprintf(stderr, "%s: not a sample record file\n", path);
+            return false;
+        }
+        if (header.crc16 != sample_bin_crc16(data.data(), sizeof(header) - sizeof(header.crc16)))
+        {
+            std::fprintf(stderr, "%s: header CRC mismatch\n", path);
+            return false;
+        }
+        if (header.version != SAMPLE_BIN_VERSION || header.value_format != SAMPLE_BIN_FORMAT_Q16)
+        {
+            std::fprintf(stderr, "%s: unsupported version %u format %u\n", path, header.version, header.value_format);
+            return false;
+        }
+        if (header.header_size < sizeof(header) || header.header_size > data.size() || header.channels == 0 ||
+            header.record_size != SAMPLE_BIN_RECORD_SIZE(header.channels) || header.tick_hz == 0)
+        {
+            std::fprintf(stderr, "%s: inconsistent header\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    void write_column_names()
+    {
+        buffer_ += "time";
+        for (unsigned ch = 0; ch < channels_; ch++)
+        {
+            buffer_ += ",ch";
+            append_uint(buffer_, ch);
+        }
+        buffer_ += ",overlimit,flags,sequence\n";
+    }
+
+    void write_record(const uint8_t *p, const sample_bin_header_t &header, uint16_t sequence)
+    {
+        uint32_t time = load<uint32_t>(p);
+        uint32_t ticks = load<uint16_t>(p + 4);
+
+        buffer_ += time_.format(time);
+        buffer_.push_back('.');
+        append_padded(buffer_, static_cast<uint32_t>(static_cast<uint64_t>(ticks) * 1000 / header.tick_hz), 3);
+
+        const uint8_t *value = p + SAMPLE_BIN_VALUE_OFFSET;
+        for (unsigned ch = 0; ch < header.channels; ch++, value += 4)
+        {
+            buffer_.push_back(',');
+            append_q16(buffer_, load<int32_t>(value));
+        }
+
+        buffer_.push_back(',');
+        append_uint(buffer_, p[6]);
+        buffer_.push_back(',');
+        append_uint(buffer_, p[7]);
+        buffer_.push_back(',');
+        append_uint(buffer_, sequence);
+        buffer_.push_back('\n');
+
+        if (buffer_.size() >= kFlushBytes)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!buffer_.empty())
+        {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+            buffer_.clear();
+        }
+    }
+
+    FILE *out_;
+    std::string buffer_;
+    TimeFormatter time_;
+    unsigned channels_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *output = nullptr;
+    std::vector<const char *> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+            inputs.push_back(argv[i]);
+    }
+    if (inputs.empty())
+    {
+        std::fprintf(stderr, "usage: %s [-o out.csv] file.bin...\n", argv[0]);
+        return 2;
+    }
+
+    FILE *out = output ? std::fopen(output, "wb") : stdout;
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "%s: cannot create\n", output);
+        return 1;
+    }
+
+    int status = 0;
+    {
+        Converter converter(out);
+        for (const char *path : inputs)
+        {
+            FileStats stats;
+            if (!converter.convert(path, stats))
+            {
+                status = 1;
+                continue;
+            }
+            std::fprintf(stderr, "%s: %llu records, %llu CRC errors, %llu sequence gaps, %llu trailing bytes\n", path,
+                         static_cast<unsigned long long>(stats.records),
+                         static_cast<unsigned long long>(stats.crc_errors),
+                         static_cast<unsigned long long>(stats.sequence_gaps),
+                         static_cast<unsigned long long>(stats.trailing_bytes));
+        }
+    }
+
+    if (out != stdout)
+        std::fclose(out);
+    return status;
+}
@@ -0,0 +1,21 @@
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+// 主机仿真用的CMSIS-DSP替身：未定义ARM_MATH_DSP，adc_reduce走标量实现；
+// 三角函数直接映射到libm
+
+#include <math.h>
+
+#define PI 3.14159265358979f
+
+static inline float arm_cos_f32(float x)
+{
+    return cosf(x);
+}
+
+static inline float arm_sin_f32(float x)
+{
+    return sinf(x);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __MAIN_H
+#define __MAIN_H
+
+// 主机仿真用的HAL替身：只提供仿真中编译的固件模块用到的类型与函数，
+// 优先于Core/Inc/main.h被包含。HAL_GetTick由rtos_sim.c用单调时钟实现。
+
+#include <stdint.h>
+
+#define __IO volatile
+
+typedef struct
+{
+    uint8_t Hours;
+    uint8_t Minutes;
+    uint8_t Seconds;
+    uint32_t SubSeconds;
+    uint32_t SecondFraction;
+} RTC_TimeTypeDef;
+
+typedef struct
+{
+    uint8_t WeekDay;
+    uint8_t Month;
+    uint8_t Date;
+    uint8_t Year;
+} RTC_DateTypeDef;
+
+uint32_t HAL_GetTick(void);
+
+#endif
@@ -0,0 +1,408 @@
+// 抢占式执行模式的主机仿真：在Linux上运行与固件相同的app_threads线程结构，
+// 用模拟的DMA半区中断驱动采集线程，用随机的SD卡写入延迟加载SD卡线程，
+// 检查采集线程的唤醒延迟是否始终小于半区周期（即不丢块），以及每条采样记录都经存储队列写出。
+//
+// 各线程运行固件的真实代码，只有外设由替身代替(hal_stub/，优先于Core/Inc被包含)：
+//   采集线程：合成的50Hz含谐波信号数据块，经adc_reduce、adc_decimate、adc_harmonic处理；
+//   采样线程：由处理结果生成采样记录，经sample_bus发布，订阅者格式化后写入spsc_ring存储队列；
+//   串口/界面线程：读取sample_bus最近一条记录并格式化；
+//   SD卡线程：从存储队列取出记录、检查发布序号连续，按随机延迟模拟SD卡写入。
+// adc_app.c、sampling_control.c、data_storage.c本身直接访问TIM/DMA/RTC寄存器与FatFs，仍不在仿真中编译。
+//
+// 编译：
+//   gcc -O2 -std=gnu99 -DOSAL_POSIX -Ihal_stub -I../../sysFunction -I../../Components/Ringbuffer -o rtos_sim rtos_sim.c
+//       ../../sysFunction/app_threads.c ../../sysFunction/osal_posix.c ../../sysFunction/periodic_timer.c
+//       ../../sysFunction/adc_reduce.c ../../sysFunction/adc_decimate.c ../../sysFunction/adc_harmonic.c
+//       ../../sysFunction/sample_bus.c ../../Components/Ringbuffer/spsc_ring.c -lpthread -lm
+// 运行：
+//   ./rtos_sim [秒数=10] [采样率Hz=10000] [SD最大延迟ms=250]
+// 以root运行时线程使用SCHED_FIFO优先级，结果更接近目标板。
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "app_threads.h"
+#include "adc_reduce.h"
+#include "adc_decimate.h"
+#include "adc_harmonic.h"
+#include "sample_bus.h"
+#include "spsc_ring.h"
+
+#define SIM_EVENT_QUEUE_LEN 4  // 与adc_app事件队列一致
+#define SIM_SAMPLE_MS 20       // 采样记录周期，比固件的最短5s周期密得多，用于加载存储队列
+#define SIM_QUEUE_SIZE 4096    // 与data_storage记录队列一致
+#define SIM_RECORD_MAX 256
+
+typedef struct
+{
+    uint64_t post_us;
+    uint8_t half; // 就绪的半区
+} sim_event_t;
+
+static sim_event_t sim_queue[SIM_EVENT_QUEUE_LEN];
+static volatile uint32_t sim_head = 0;
+static volatile uint32_t sim_tail = 0;
+
+static volatile uint32_t sim_posted = 0;
+static volatile uint32_t sim_processed = 0;
+static volatile uint32_t sim_overflow = 0;
+static volatile uint64_t sim_latency_max_us = 0;
+static volatile uint64_t sim_latency_sum_us = 0;
+static volatile uint64_t sim_work_max_us = 0;
+static volatile uint32_t sim_sd_writes = 0;
+static volatile uint32_t sim_sd_max_ms = 250;
+static volatile uint32_t sim_uart_runs = 0;
+static uint32_t sim_rate_hz = 10000;
+
+// DMA双缓冲：DMA线程写一个半区时采集线程处理另一个
+static uint16_t sim_dma_buffer[2][ADC_BLOCK_SAMPLES];
+static uint64_t sim_frame = 0;
+
+// 采集结果，由acq_lock保护
+static adc_channel_stats_t sim_stats[ADC_CHANNEL_COUNT];
+static adc_decimate_result_t sim_decimate[ADC_CHANNEL_COUNT];
+static adc_wave_stats_t sim_wave[ADC_CHANNEL_COUNT];
+static adc_harmonic_result_t sim_harmonic[ADC_CHANNEL_COUNT];
+static float sim_voltage[ADC_CHANNEL_COUNT];
+
+// 存储队列：与data_storage相同，记录头部后紧跟内容
+typedef struct
+{
+    uint32_t sequence;
+    uint16_t length;
+} sim_msg_t;
+
+static spsc_ring_t sim_storage_queue;
+static uint8_t sim_storage_pool[SIM_QUEUE_SIZE];
+static volatile uint32_t sim_published = 0;
+static volatile uint32_t sim_queued = 0;
+static volatile uint32_t sim_dropped = 0;
+static volatile uint32_t sim_stored = 0;
+static volatile uint32_t sim_order_errors = 0;
+static uint32_t sim_last_stored = 0;
+
+static uint64_t sim_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return osal_now_ms();
+}
+
+// 忙等模拟CPU占用
+static void sim_burn_us(uint32_t us)
+{
+    uint64_t end = sim_now_us() + us;
+
+    while (sim_now_us() < end)
+    {
+    }
+}
+
+static void sim_sleep_us(uint64_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000u;
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+// 合成一个半区：各通道为50Hz基波加10%三次谐波与少量噪声，12位码值
+static void sim_fill_block(uint16_t *block)
+{
+    for (uint32_t f = 0; f < ADC_BLOCK_FRAMES; f++, sim_frame++)
+    {
+        double t = (double)sim_frame / sim_rate_hz;
+        for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+        {
+            double w = 2.0 * M_PI * 50.0 * t + ch * 0.5;
+            double code = 2048.0 + (800.0 + 200.0 * ch) * (sin(w) + 0.1 * sin(3.0 * w)) + (rand() % 5 - 2);
+            block[f * ADC_CHANNEL_COUNT + ch] = (uint16_t)code;
+        }
+    }
+}
+
+// 模拟DMA半区中断：填满一个半区后入队并唤醒采集线程，队列满记为溢出
+static void *sim_dma_thread(void *arg)
+{
+    uint64_t period_us = *(uint64_t *)arg;
+    uint64_t next;
+    uint8_t half = 0;
+
+    sim_sleep_us(100000); // 等待app_threads_start创建队列
+    next = sim_now_us() + period_us;
+
+    while (1)
+    {
+        uint64_t now = sim_now_us();
+        if (next > now)
+            sim_sleep_us(next - now);
+        next += period_us;
+
+        uint32_t head = sim_head;
+        if (head - sim_tail >= SIM_EVENT_QUEUE_LEN)
+        {
+            sim_overflow++;
+        }
+        else
+        {
+            sim_fill_block(sim_dma_buffer[half]);
+            sim_queue[head & (SIM_EVENT_QUEUE_LEN - 1)].post_us = sim_now_us();
+            sim_queue[head & (SIM_EVENT_QUEUE_LEN - 1)].half = half;
+            __atomic_store_n(&sim_head, head + 1, __ATOMIC_RELEASE);
+            half ^= 1;
+        }
+        sim_posted++;
+        app_notify_acq_from_isr();
+    }
+    return NULL;
+}
+
+// 块处理互斥，与adc_app.c的RTOS模式相同
+void adc_event_lock(void)
+{
+    app_acq_lock();
+}
+
+void adc_event_unlock(void)
+{
+    app_acq_unlock();
+}
+
+// 以下为线程调用的任务入口：与固件各任务相同的处理步骤，调用固件模块的实现
+
+// 采集：与adc_process_block相同的归约、抽取、波形参数与谐波分析
+void adc_event_drain(void)
+{
+    while (sim_tail != __atomic_load_n(&sim_head, __ATOMIC_ACQUIRE))
+    {
+        uint32_t tail = sim_tail;
+        sim_event_t event = sim_queue[tail & (SIM_EVENT_QUEUE_LEN - 1)];
+        const uint16_t *block = sim_dma_buffer[event.half];
+        uint64_t latency = sim_now_us() - event.post_us;
+        uint64_t start = sim_now_us();
+
+        app_acq_lock();
+        adc_reduce(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, sim_stats);
+        adc_decimate_block(block, ADC_BLOCK_FRAMES, sim_decimate);
+        for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+        {
+            float mean = (float)sim_stats[ch].sum / sim_stats[ch].count;
+            float avg = sim_decimate[ch].count > 0 ? sim_decimate[ch].mean : mean;
+            sim_voltage[ch] = avg * ADC_CODE_TO_VOLT;
+            adc_wave_from_stats(&sim_stats[ch], ADC_CODE_TO_VOLT, &sim_wave[ch]);
+            adc_harmonic_block(block, ADC_BLOCK_FRAMES, ADC_CHANNEL_COUNT, ch, mean, (float)sim_rate_hz,
+                               &sim_harmonic[ch]);
+        }
+        app_acq_unlock();
+
+        uint64_t work = sim_now_us() - start;
+        if (work > sim_work_max_us)
+            sim_work_max_us = work;
+        if (latency > sim_latency_max_us)
+            sim_latency_max_us = latency;
+        sim_latency_sum_us += latency;
+        sim_processed++;
+        sim_tail = tail + 1;
+    }
+}
+
+// 串口输出：格式化最近一条采样记录
+void uart_task(void)
+{
+    sample_record_t record;
+    char line[SIM_RECORD_MAX];
+
+    sim_uart_runs++;
+    if (sample_bus_latest(&record))
+    {
+        snprintf(line, sizeof(line), "%lu ch0 %.3fV", (unsigned long)record.sequence, record.voltage[0]);
+    }
+}
+
+// 存储订阅者：格式化记录后入队，队列满时丢弃并计数，与data_storage的入队相同
+static void sim_store_record(const sample_record_t *record)
+{
+    char line[SIM_RECORD_MAX];
+    int length = snprintf(line, sizeof(line), "%lu", (unsigned long)record->tick);
+
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        const sample_wave_t *wave = &record->wave[ch];
+        length += snprintf(line + length, sizeof(line) - length, ",%.3f,%.3f,%.3f,%.2f", record->voltage[ch],
+                           wave->rms, wave->peak_to_peak, wave->thd);
+    }
+
+    sim_msg_t msg = {record->sequence, (uint16_t)length};
+    if (spsc_ring_free(&sim_storage_queue) < sizeof(msg) + msg.length)
+    {
+        sim_dropped++;
+        return;
+    }
+    spsc_ring_write(&sim_storage_queue, (const uint8_t *)&msg, sizeof(msg));
+    spsc_ring_write(&sim_storage_queue, (const uint8_t *)line, msg.length);
+    sim_queued++;
+}
+
+// 采样：按记录周期在acq_lock下取采集结果，生成记录经采样总线发布
+void sampling_task(void)
+{
+    static uint32_t last_ms = 0;
+    uint32_t now = osal_now_ms();
+    sample_record_t record;
+
+    if (now - last_ms < SIM_SAMPLE_MS)
+        return;
+    last_ms = now;
+
+    memset(&record, 0, sizeof(record));
+    record.tick = now;
+    record.flags = SAMPLE_REC_WAVE;
+    app_acq_lock();
+    for (uint8_t ch = 0; ch < ADC_CHANNEL_COUNT; ch++)
+    {
+        record.voltage[ch] = sim_voltage[ch];
+        record.wave[ch].valid = SAMPLE_WAVE_STATS | SAMPLE_WAVE_THD;
+        record.wave[ch].rms = sim_wave[ch].rms;
+        record.wave[ch].peak_to_peak = sim_wave[ch].peak_to_peak;
+        record.wave[ch].crest_factor = sim_wave[ch].crest_factor;
+        record.wave[ch].thd = sim_harmonic[ch].thd;
+    }
+    app_acq_unlock();
+
+    sample_bus_publish(&record);
+    sim_published++;
+}
+
+// 存储：取出队列中的全部记录，检查发布序号递增；偶发长时间阻塞，模拟SD卡擦除/同步
+void data_storage_task(void)
+{
+    sim_msg_t msg;
+    char line[SIM_RECORD_MAX];
+
+    while (spsc_ring_peek(&sim_storage_queue, (uint8_t *)&msg, sizeof(msg)) == sizeof(msg) &&
+           spsc_ring_used(&sim_storage_queue) >= sizeof(msg) + msg.length)
+    {
+        spsc_ring_release(&sim_storage_queue, sizeof(msg));
+        spsc_ring_read(&sim_storage_queue, (uint8_t *)line, msg.length);
+        if (msg.sequence <= sim_last_stored)
+            sim_order_errors++;
+        sim_last_stored = msg.sequence;
+        sim_stored++;
+    }
+
+    if (rand() % 20 == 0)
+    {
+        sim_sleep_us((uint64_t)(rand() % (sim_sd_max_ms + 1)) * 1000);
+        sim_sd_writes++;
+    }
+}
+
+void config_task(void)
+{
+}
+
+void led_task(void)
+{
+}
+
+void key_proc(void)
+{
+}
+
+// 界面：读取最近一条记录并模拟刷新屏幕的耗时
+void oled_task(void)
+{
+    sample_record_t record;
+
+    sample_bus_latest(&record);
+    sim_burn_us(200);
+}
+
+typedef struct
+{
+    uint32_t seconds;
+    uint64_t period_us;
+} sim_monitor_arg_t;
+
+// 每秒打印统计，结束时根据是否丢块、丢记录给出退出码
+static void *sim_monitor_thread(void *arg)
+{
+    sim_monitor_arg_t *monitor = (sim_monitor_arg_t *)arg;
+    app_thread_stats_t stats;
+
+    for (uint32_t s = 1; s <= monitor->seconds; s++)
+    {
+        sleep(1);
+        printf("t=%2us posted %u processed %u overflow %u latency max %.2f ms avg %.3f ms work max %.2f ms "
+               "sd writes %u\n",
+               s, sim_posted, sim_processed, sim_overflow, sim_latency_max_us / 1000.0,
+               sim_processed ? (double)sim_latency_sum_us / sim_processed / 1000.0 : 0.0, sim_work_max_us / 1000.0,
+               sim_sd_writes);
+    }
+
+    printf("thread     runs  max_wait_ms  overruns\n");
+    for (uint8_t i = 0; i < APP_THREAD_COUNT; i++)
+    {
+        app_threads_get_stats((app_thread_id_t)i, &stats);
+        printf("%-8s %6u %12u %9u\n", app_threads_get_name((app_thread_id_t)i), stats.runs, stats.max_wait_ms,
+               stats.overruns);
+    }
+
+    // 监视线程不持锁，队列中可能还有未取出的记录
+    uint32_t in_queue = sim_queued - sim_stored;
+    printf("records published %u queued %u stored %u in queue %u dropped %u order errors %u\n", sim_published,
+           sim_queued, sim_stored, in_queue, sim_dropped, sim_order_errors);
+    printf("ch0 %.3fV rms %.3fV thd %.1f%%\n", sim_voltage[0], sim_wave[0].rms, sim_harmonic[0].thd);
+
+    int pass = sim_overflow == 0 && sim_latency_max_us < monitor->period_us && sim_dropped == 0 &&
+               sim_order_errors == 0;
+    printf("%s: block period %.2f ms, worst acquisition latency %.2f ms\n", pass ? "PASS" : "FAIL",
+           monitor->period_us / 1000.0, sim_latency_max_us / 1000.0);
+    exit(pass ? 0 : 1);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    static sim_monitor_arg_t monitor;
+    static uint64_t period_us;
+    pthread_t tid;
+
+    monitor.seconds = argc > 1 ? (uint32_t)atoi(argv[1]) : 10;
+    sim_rate_hz = argc > 2 ? (uint32_t)atoi(argv[2]) : sim_rate_hz;
+    sim_sd_max_ms = argc > 3 ? (uint32_t)atoi(argv[3]) : sim_sd_max_ms;
+    if (monitor.seconds == 0 || sim_rate_hz == 0)
+    {
+        fprintf(stderr, "usage: %s [seconds] [rate_hz] [sd_max_ms]\n", argv[0]);
+        return 2;
+    }
+
+    period_us = (uint64_t)ADC_BLOCK_FRAMES * 1000000u / sim_rate_hz;
+    monitor.period_us = period_us;
+    printf("rate %u Hz, block period %.2f ms, sd latency up to %u ms\n", sim_rate_hz, period_us / 1000.0,
+           sim_sd_max_ms);
+
+    adc_decimate_reset();
+    spsc_ring_init(&sim_storage_queue, sim_storage_pool, sizeof(sim_storage_pool));
+    sample_bus_subscribe(sim_store_record);
+
+    pthread_create(&tid, NULL, sim_dma_thread, &period_us);
+    pthread_create(&tid, NULL, sim_monitor_thread, &monitor);
+
+    app_threads_start();
+    fprintf(stderr, "app_threads_start failed\n");
+    return 1;
+}
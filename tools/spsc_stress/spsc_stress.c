@@ -0,0 +1,194 @@
+// spsc_ring的主机压力测试：生产者与消费者各一个pthread线程(尽量绑在不同CPU上)，
+// 生产者按随机长度写入递增的32位序号，消费者按随机长度取出并逐个检查序号连续，
+// 两侧轮流使用拷贝接口(write/read/peek)与零拷贝接口(reserve/commit、acquire/release)，
+// 结束时输出传输字节数、吞吐量与序号错误数，有错误时返回1。
+//
+// 编译：
+//   gcc -O2 -std=gnu99 -I../../Components/Ringbuffer -o spsc_stress spsc_stress.c
+//       ../../Components/Ringbuffer/spsc_ring.c -lpthread
+// 运行：
+//   ./spsc_stress [秒数=5] [环形缓冲区字节数=4096]
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spsc_ring.h"
+
+#define STRESS_CHUNK_MAX 1024 // 单次读写的最大字节数
+
+static spsc_ring_t g_ring;
+static volatile int g_stop = 0;
+
+static uint64_t g_produced = 0; // 生产者写入的字节数
+static uint64_t g_consumed = 0; // 消费者取出的字节数
+static uint64_t g_errors = 0;   // 序号不连续的次数
+static uint64_t g_peeks = 0;    // peek与随后read结果不一致的次数
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static uint32_t rand_next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// 绑定到指定CPU，CPU不足时忽略
+static void pin_cpu(int cpu)
+{
+    cpu_set_t set;
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count < 2)
+        return;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % count, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// 序号流中第offset个字节的值
+static uint8_t stream_byte(uint64_t offset)
+{
+    uint32_t value = (uint32_t)(offset / 4);
+    return (uint8_t)(value >> (8 * (offset % 4)));
+}
+
+static void *producer(void *arg)
+{
+    uint8_t chunk[STRESS_CHUNK_MAX];
+    uint32_t seed = 0x12345678;
+    uint64_t offset = 0;
+
+    (void)arg;
+    pin_cpu(0);
+    while (!g_stop)
+    {
+        uint32_t length = rand_next(&seed) % STRESS_CHUNK_MAX + 1;
+
+        if (rand_next(&seed) & 1)
+        {
+            for (uint32_t i = 0; i < length; i++)
+                chunk[i] = stream_byte(offset + i);
+            length = spsc_ring_write(&g_ring, chunk, length);
+        }
+        else
+        {
+            uint8_t *span;
+            uint32_t n = spsc_ring_reserve(&g_ring, &span);
+            if (length > n)
+                length = n;
+            for (uint32_t i = 0; i < length; i++)
+                span[i] = stream_byte(offset + i);
+            spsc_ring_commit(&g_ring, length);
+        }
+
+        offset += length;
+        if (length == 0)
+            sched_yield();
+    }
+    g_produced = offset;
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint8_t chunk[STRESS_CHUNK_MAX];
+    uint8_t peeked[STRESS_CHUNK_MAX];
+    uint32_t seed = 0x9abcdef0;
+    uint64_t offset = 0;
+
+    (void)arg;
+    pin_cpu(1);
+    for (;;)
+    {
+        uint32_t length = rand_next(&seed) % STRESS_CHUNK_MAX + 1;
+        uint32_t mode = rand_next(&seed) % 3;
+        const uint8_t *data = chunk;
+
+        if (mode == 0)
+        {
+            length = spsc_ring_read(&g_ring, chunk, length);
+        }
+        else if (mode == 1)
+        {
+            uint32_t n = spsc_ring_peek(&g_ring, peeked, length);
+            length = spsc_ring_read(&g_ring, chunk, n);
+            if (length != n || memcmp(peeked, chunk, n) != 0)
+                g_peeks++;
+        }
+        else
+        {
+            uint8_t *span;
+            uint32_t n = spsc_ring_acquire(&g_ring, &span);
+            if (length > n)
+                length = n;
+            memcpy(chunk, span, length);
+            spsc_ring_release(&g_ring, length);
+        }
+
+        for (uint32_t i = 0; i < length; i++)
+        {
+            if (data[i] != stream_byte(offset + i))
+            {
+                g_errors++;
+                break;
+            }
+        }
+        offset += length;
+
+        if (length == 0)
+        {
+            // 生产者已停止且数据取空才结束
+            if (g_stop && spsc_ring_used(&g_ring) == 0)
+                break;
+            sched_yield();
+        }
+    }
+    g_consumed = offset;
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    uint32_t size = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 4096;
+    uint8_t *pool = malloc(size);
+    pthread_t producer_thread, consumer_thread;
+
+    if (pool == NULL || spsc_ring_init(&g_ring, pool, size) != 0)
+    {
+        fprintf(stderr, "ring size %u is not a power of two\n", size);
+        return 1;
+    }
+
+    uint64_t start = now_us();
+    pthread_create(&consumer_thread, NULL, consumer, NULL);
+    pthread_create(&producer_thread, NULL, producer, NULL);
+    sleep(seconds);
+    g_stop = 1;
+    pthread_join(producer_thread, NULL);
+    pthread_join(consumer_thread, NULL);
+    uint64_t elapsed = now_us() - start;
+
+    printf("ring %u bytes, %d s\n", size, seconds);
+    printf("produced %llu bytes, consumed %llu bytes\n", (unsigned long long)g_produced,
+           (unsigned long long)g_consumed);
+    printf("throughput %.1f MB/s\n", elapsed ? (double)g_consumed / elapsed : 0.0);
+    printf("sequence errors %llu, peek mismatches %llu\n", (unsigned long long)g_errors,
+           (unsigned long long)g_peeks);
+
+    free(pool);
+    return (g_errors || g_peeks || g_produced != g_consumed) ? 1 : 0;
+}
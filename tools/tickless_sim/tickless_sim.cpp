@@ -0,0 +1,323 @@
+// 裸机调度器的主机仿真：把sysFunction/scheduler.c与periodic_timer.c原样编译进来，
+// 用虚拟的SysTick/DWT/SCB寄存器代替内核外设，按CPU周期推进虚拟时间，运行固件的任务表，
+// 结束时调用scheduler_print_stats输出与串口stats命令相同的统计(次数、启动延迟、停节拍休眠)。
+//
+// 寄存器按Cortex-M手册的行为建模：SysTick写VAL清零计数与COUNTFLAG，读CTRL清COUNTFLAG，
+// 计数到0时挂起中断、下一个周期从LOAD重装；关中断期间中断保持挂起，WFI在有挂起中断时返回。
+// 除SysTick外另有一个周期性外设中断(默认为10kHz采样率下的ADC DMA半区中断)，用于产生提前唤醒。
+// 各任务的执行时间为估计值(见sim_costs)，只影响空闲率与延迟的数值，不影响能否进入停节拍休眠。
+//
+// 编译：
+//   g++ -O2 -std=c++17 -I../../sysFunction -o tickless_sim tickless_sim.cpp
+// 运行：
+//   ./tickless_sim [秒数=10] [外设中断周期us=51200，0为无] [停节拍休眠=1]
+// 以C++编译只是为了用寄存器代理对象模拟读写副作用，被包含的固件源码仍是C。
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// 屏蔽固件头文件链(mydefine.h引入HAL与各外设驱动)，以下提供scheduler.c用到的全部声明
+#define __MYDEFINE_H
+#define __IO volatile
+
+namespace
+{
+constexpr uint32_t kCoreClock = 168000000;
+constexpr uint32_t kCyclesPerUs = kCoreClock / 1000000;
+constexpr uint32_t kWakeCycles = 12; // WFI被挂起中断唤醒到恢复执行的周期数
+constexpr uint32_t kIsrCycles = 12;  // 中断进入(压栈)的周期数
+
+uint64_t sim_cycles = 0;       // 虚拟时间(CPU周期)
+bool sim_irq_enabled = true;   // PRIMASK
+bool sim_systick_pending = false;
+bool sim_ext_pending = false;
+uint64_t sim_ext_period = 0;   // 外设中断周期(周期数)，0为无
+uint64_t sim_ext_next = 0;
+uint32_t sim_ext_count = 0;
+
+struct sim_systick_state
+{
+    bool enabled = false;
+    uint32_t load = 0;
+    uint32_t val = 0;
+    bool countflag = false;
+} sim_tick;
+
+// 寄存器代理：读写时调用对应的副作用函数
+struct sim_reg
+{
+    uint32_t (*read)();
+    void (*write)(uint32_t);
+
+    operator uint32_t() const { return read(); }
+    sim_reg &operator=(uint32_t v)
+    {
+        write(v);
+        return *this;
+    }
+    sim_reg &operator|=(uint32_t v)
+    {
+        write(read() | v);
+        return *this;
+    }
+    sim_reg &operator&=(uint32_t v)
+    {
+        write(read() & v);
+        return *this;
+    }
+};
+
+uint32_t systick_ctrl_read()
+{
+    uint32_t v = (sim_tick.enabled ? 1u : 0u) | 0x6u | (sim_tick.countflag ? (1u << 16) : 0u);
+    sim_tick.countflag = false;
+    return v;
+}
+// 使能时计数值为0则在下一个时钟从LOAD重装；固件使能后紧接着改写LOAD，重装先于该写入发生
+void systick_ctrl_write(uint32_t v)
+{
+    bool enable = (v & 1u) != 0;
+    if (enable && !sim_tick.enabled && sim_tick.val == 0)
+        sim_tick.val = sim_tick.load;
+    sim_tick.enabled = enable;
+}
+uint32_t systick_load_read() { return sim_tick.load; }
+void systick_load_write(uint32_t v) { sim_tick.load = v & 0xFFFFFFu; }
+uint32_t systick_val_read() { return sim_tick.val; }
+void systick_val_write(uint32_t)
+{
+    sim_tick.val = 0;
+    sim_tick.countflag = false;
+}
+uint32_t scb_icsr_read() { return sim_systick_pending ? (1u << 26) : 0u; }
+void scb_icsr_write(uint32_t) {}
+} // namespace
+
+struct SysTick_Type
+{
+    sim_reg CTRL{systick_ctrl_read, systick_ctrl_write};
+    sim_reg LOAD{systick_load_read, systick_load_write};
+    sim_reg VAL{systick_val_read, systick_val_write};
+};
+struct SCB_Type
+{
+    sim_reg ICSR{scb_icsr_read, scb_icsr_write};
+};
+struct DWT_Type
+{
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+};
+struct CoreDebug_Type
+{
+    uint32_t DEMCR;
+};
+
+static SysTick_Type sim_systick_regs;
+static SCB_Type sim_scb_regs;
+static DWT_Type sim_dwt_regs;
+static CoreDebug_Type sim_coredebug_regs;
+
+#define SysTick (&sim_systick_regs)
+#define SCB (&sim_scb_regs)
+#define DWT (&sim_dwt_regs)
+#define CoreDebug (&sim_coredebug_regs)
+// 目标上UL为32位，主机上用U保持同样的位宽
+#define SysTick_CTRL_ENABLE_Msk (1U << 0)
+#define SysTick_CTRL_COUNTFLAG_Msk (1U << 16)
+#define SysTick_LOAD_RELOAD_Msk 0xFFFFFFU
+#define SCB_ICSR_PENDSTSET_Msk (1U << 26)
+#define CoreDebug_DEMCR_TRCENA_Msk (1U << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1U << 0)
+
+uint32_t SystemCoreClock = kCoreClock;
+volatile uint32_t uwTick = 0;
+uint32_t uwTickFreq = 1;
+
+uint32_t HAL_GetTick(void) { return uwTick; }
+static void HAL_IncTick(void) { uwTick += uwTickFreq; }
+
+struct UART_HandleTypeDef
+{
+    int unused;
+};
+UART_HandleTypeDef huart1;
+
+static int my_printf(UART_HandleTypeDef *, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+static void sim_wfi();
+static void sim_enable_irq();
+#define __disable_irq() (sim_irq_enabled = false)
+#define __enable_irq() sim_enable_irq()
+#define __WFI() sim_wfi()
+#define __DSB()
+#define __ISB()
+
+void led_task(void);
+void adc_task(void);
+void key_proc(void);
+void uart_task(void);
+void oled_task(void);
+void sampling_task(void);
+void config_task(void);
+void data_storage_task(void);
+
+#include "../../sysFunction/periodic_timer.c"
+#include "../../sysFunction/scheduler.c"
+
+namespace
+{
+// 中断服务：SysTick同固件stm32f4xx_it.c中的SysTick_Handler，外设中断只计数
+uint64_t sim_advance(uint64_t n, bool stop_on_pending);
+
+void sim_run_isrs()
+{
+    sim_irq_enabled = false;
+    sim_advance(kIsrCycles, false);
+    if (sim_systick_pending)
+    {
+        sim_systick_pending = false;
+        HAL_IncTick();
+        scheduler_tick_hook();
+    }
+    if (sim_ext_pending)
+    {
+        sim_ext_pending = false;
+        sim_ext_count++;
+    }
+    sim_irq_enabled = true;
+}
+
+// 推进虚拟时间，最多n个周期；stop_on_pending时在出现挂起中断处停下。返回实际推进的周期数
+uint64_t sim_advance(uint64_t n, bool stop_on_pending)
+{
+    uint64_t done = 0;
+
+    while (done < n)
+    {
+        uint64_t step = n - done;
+
+        if (sim_ext_period && sim_ext_next - sim_cycles < step)
+            step = sim_ext_next - sim_cycles;
+        if (sim_tick.enabled)
+        {
+            if (sim_tick.val == 0)
+                step = 1; // 本周期从LOAD重装
+            else if (sim_tick.val < step)
+                step = sim_tick.val;
+        }
+
+        sim_cycles += step;
+        sim_dwt_regs.CYCCNT += (uint32_t)step;
+        done += step;
+
+        if (sim_tick.enabled)
+        {
+            if (sim_tick.val == 0)
+            {
+                sim_tick.val = sim_tick.load;
+            }
+            else
+            {
+                sim_tick.val -= (uint32_t)step;
+                if (sim_tick.val == 0)
+                {
+                    sim_tick.countflag = true;
+                    sim_systick_pending = true;
+                }
+            }
+        }
+        if (sim_ext_period && sim_cycles >= sim_ext_next)
+        {
+            sim_ext_pending = true;
+            sim_ext_next += sim_ext_period;
+        }
+
+        if (sim_systick_pending || sim_ext_pending)
+        {
+            if (sim_irq_enabled)
+                sim_run_isrs();
+            else if (stop_on_pending)
+                break;
+        }
+    }
+    return done;
+}
+
+// 任务执行时间的估计值(us)，与任务表顺序无关，按函数登记
+uint32_t sim_costs[8] = {
+    5,    // led
+    40,   // adc
+    10,   // key
+    30,   // uart
+    1200, // oled，I2C刷新
+    60,   // sampling
+    5,    // config
+    150,  // storage
+};
+
+void sim_busy(uint8_t id)
+{
+    sim_advance((uint64_t)sim_costs[id] * kCyclesPerUs, false);
+}
+} // namespace
+
+static void sim_wfi()
+{
+    if (sim_systick_pending || sim_ext_pending)
+        return;
+    sim_advance(UINT64_MAX, true);
+    sim_advance(kWakeCycles, false);
+}
+
+static void sim_enable_irq()
+{
+    sim_irq_enabled = true;
+    if (sim_systick_pending || sim_ext_pending)
+        sim_run_isrs();
+}
+
+void led_task(void) { sim_busy(0); }
+void adc_task(void) { sim_busy(1); }
+void key_proc(void) { sim_busy(2); }
+void uart_task(void) { sim_busy(3); }
+void oled_task(void) { sim_busy(4); }
+void sampling_task(void) { sim_busy(5); }
+void config_task(void) { sim_busy(6); }
+void data_storage_task(void) { sim_busy(7); }
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = argc > 1 ? (uint32_t)atoi(argv[1]) : 10;
+    uint32_t ext_us = argc > 2 ? (uint32_t)atoi(argv[2]) : 51200;
+    uint8_t tickless = argc > 3 ? (uint8_t)atoi(argv[3]) : 1;
+
+    sim_ext_period = (uint64_t)ext_us * kCyclesPerUs;
+    sim_ext_next = sim_ext_period;
+
+    // HAL_InitTick：1kHz节拍，SysTick使用内核时钟
+    sim_tick.load = kCoreClock / 1000 - 1;
+    sim_tick.val = sim_tick.load;
+    sim_tick.enabled = true;
+
+    scheduler_init();
+    scheduler_set_tickless(tickless);
+    while (sim_cycles < (uint64_t)seconds * kCoreClock)
+    {
+        scheduler_run();
+    }
+
+    printf("simulated %u s, tick %u ms, peripheral interrupts %u\r\n", seconds, uwTick, sim_ext_count);
+    scheduler_print_stats();
+    return 0;
+}